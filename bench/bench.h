@@ -0,0 +1,83 @@
+#pragma once
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <string>
+
+/* --- Benchmark harness --- */
+
+enum class Throughput { BYTES, ITEMS };
+
+template<typename T>
+void do_not_optimize(const T &value) {
+	asm volatile("" : : "r,m"(value) : "memory");
+}
+
+struct Benchmark_Runner {
+	explicit Benchmark_Runner(int argc, char *argv[])
+		: filter_{argc > 1 ? argv[1] : ""} { }
+
+	/* Runs func repeatedly until at least min_time has elapsed and reports the mean time per call
+	 * along with the throughput, where each call processes `work` bytes or items. */
+	template<typename FuncT>
+	void run(const std::string &name, std::size_t work, Throughput unit, const FuncT &func) const {
+		if (!filter_.empty() && name.find(filter_) == std::string::npos)
+			return;
+
+		using Clock = std::chrono::steady_clock;
+		std::size_t iterations{1};
+		for (;;) {
+			const auto start = Clock::now();
+			for (std::size_t i = 0; i < iterations; ++i)
+				func();
+			const std::chrono::duration<double> elapsed = Clock::now() - start;
+			if (elapsed.count() >= min_time || iterations >= max_iterations) {
+				const auto seconds_per_call = elapsed.count() / static_cast<double>(iterations);
+				const auto rate = static_cast<double>(work) / seconds_per_call;
+				std::printf("%-48s %12.0f ns %10.2f %s\n", name.c_str(), seconds_per_call * 1e9,
+							unit == Throughput::BYTES ? rate / (1 << 20) : rate / 1e6,
+							unit == Throughput::BYTES ? "MiB/s" : "M items/s");
+				return;
+			}
+			iterations *= 2;
+		}
+	}
+
+private:
+	static constexpr double min_time{0.25};
+	static constexpr std::size_t max_iterations{std::size_t{1} << 30};
+
+	std::string filter_;
+};
+
+/* --- Input generation --- */
+
+[[nodiscard]] inline std::mt19937_64 &bench_rng() {
+	static std::mt19937_64 rng{2023};
+	return rng;
+}
+
+[[nodiscard]] inline std::string random_number_line(std::size_t bytes, char delim = ' ') {
+	std::uniform_int_distribution<int> dist{0, 99999};
+	std::string line;
+	while (line.size() < bytes) {
+		if (!line.empty())
+			line += delim;
+		line += std::to_string(dist(bench_rng()));
+	}
+	return line;
+}
+
+[[nodiscard]] inline std::string random_grid(std::size_t rows, std::size_t columns, const std::string &alphabet = ".#") {
+	std::uniform_int_distribution<std::size_t> dist{0, alphabet.size() - 1};
+	std::string grid;
+	grid.reserve(rows * (columns + 1));
+	for (std::size_t r = 0; r < rows; ++r) {
+		for (std::size_t c = 0; c < columns; ++c)
+			grid += alphabet[dist(bench_rng())];
+		grid += '\n';
+	}
+	return grid;
+}
@@ -0,0 +1,139 @@
+#include "common.h"
+#include "bench.h"
+#include <array>
+#include <cmath>
+#include <numeric>
+#include <spanstream>
+
+static constexpr std::array<std::size_t, 3> input_sizes{1 << 10, 1 << 14, 1 << 18};
+
+struct Counting_Token_Reader : Token_Reader<Counting_Token_Reader> {
+	void read_token(const std::string &token) final {
+		bytes_ += token.size();
+	}
+
+	std::size_t bytes_{0};
+};
+
+struct Counting_Paragraph_Reader : Paragraph_Reader<Counting_Paragraph_Reader> {
+	void read_line(const std::string &line) final {
+		bytes_ += line.size();
+	}
+
+	std::size_t bytes_{0};
+};
+
+static void bench_readers(const Benchmark_Runner &runner) {
+	for (auto size : input_sizes) {
+		const auto line = random_number_line(size);
+		const auto suffix = std::string{"/"}.append(std::to_string(size));
+
+		runner.run("read_tokens" + suffix, line.size(), Throughput::BYTES, [&line]() {
+			std::ispanstream in{line};
+			do_not_optimize(read_tokens(in).size());
+		});
+		runner.run("read_tokens/stoi" + suffix, line.size(), Throughput::BYTES, [&line]() {
+			std::ispanstream in{line};
+			do_not_optimize(read_tokens(in, ' ', [](const auto &token) { return std::stoi(token); }).size());
+		});
+		runner.run("Token_Reader::create_from_string" + suffix, line.size(), Throughput::BYTES, [&line]() {
+			do_not_optimize(Counting_Token_Reader::create_from_string(line).bytes_);
+		});
+	}
+
+	for (auto size : input_sizes) {
+		const auto side = static_cast<std::size_t>(std::sqrt(static_cast<double>(size)));
+		const auto grid = random_grid(side, side);
+		const auto suffix = std::string{"/"}.append(std::to_string(grid.size()));
+
+		runner.run("read_grid" + suffix, grid.size(), Throughput::BYTES, [&grid]() {
+			std::ispanstream in{grid};
+			do_not_optimize(read_grid(in).size());
+		});
+		runner.run("Paragraph_Reader" + suffix, grid.size(), Throughput::BYTES, [&grid]() {
+			std::ispanstream in{grid};
+			do_not_optimize(Counting_Paragraph_Reader::create_from_stream(in).bytes_);
+		});
+	}
+}
+
+static void bench_algorithms(const Benchmark_Runner &runner) {
+	for (auto size : input_sizes) {
+		Circular_Queue<char, std::string> queue{std::string(size, 'L')};
+		runner.run("Circular_Queue::take/" + std::to_string(size), size, Throughput::ITEMS, [&queue, size]() {
+			std::size_t sum{0};
+			for (std::size_t i = 0; i < size; ++i)
+				sum += queue.take();
+			do_not_optimize(sum);
+		});
+
+		std::vector<std::size_t> numbers(size);
+		std::uniform_int_distribution<std::size_t> dist;
+		std::ranges::generate(numbers, [&dist]() { return dist(bench_rng()) >> (dist(bench_rng()) % 64); });
+		runner.run("count_digits/" + std::to_string(size), size, Throughput::ITEMS, [&numbers]() {
+			std::size_t sum{0};
+			for (auto number : numbers)
+				sum += count_digits(number);
+			do_not_optimize(sum);
+		});
+	}
+
+	for (std::size_t size : {1 << 6, 1 << 9, 1 << 12}) {
+		std::vector<int> values(size);
+		std::iota(values.begin(), values.end(), 0);
+		runner.run("foreach_combination/" + std::to_string(size), size * (size - 1) / 2, Throughput::ITEMS, [&values]() {
+			long sum{0};
+			ranges_foreach_combination(values, [&sum](auto lhs, auto rhs) { sum += lhs ^ rhs; });
+			do_not_optimize(sum);
+		});
+	}
+}
+
+static void bench_positions(const Benchmark_Runner &runner) {
+	for (auto size : input_sizes) {
+		const auto suffix = std::string{"/"}.append(std::to_string(size));
+
+		runner.run("Grid_Position::move" + suffix, size, Throughput::ITEMS, [size]() {
+			Grid_Position position{size, size};
+			Grid_Direction direction{Grid_Direction::UP};
+			for (std::size_t i = 0; i < size; ++i) {
+				position = position.move(direction);
+				direction = direction.turn_clockwise();
+			}
+			do_not_optimize(position.r + position.c);
+		});
+
+		runner.run("std::hash<Position>" + suffix, size, Throughput::ITEMS, [size]() {
+			std::size_t result{0};
+			for (std::size_t i = 0; i < size; ++i)
+				result ^= std::hash<Position>{}(Position{static_cast<int>(i), static_cast<int>(i >> 3)});
+			do_not_optimize(result);
+		});
+		runner.run("std::hash<Position3D>" + suffix, size, Throughput::ITEMS, [size]() {
+			std::size_t result{0};
+			for (std::size_t i = 0; i < size; ++i)
+				result ^= std::hash<Position3D>{}(Position3D{static_cast<int>(i), static_cast<int>(i >> 3), static_cast<int>(i >> 6)});
+			do_not_optimize(result);
+		});
+		runner.run("std::hash<Grid_Position>" + suffix, size, Throughput::ITEMS, [size]() {
+			std::size_t result{0};
+			for (std::size_t i = 0; i < size; ++i)
+				result ^= std::hash<Grid_Position>{}(Grid_Position{i, i >> 3});
+			do_not_optimize(result);
+		});
+		runner.run("std::hash<Grid_Direction>" + suffix, size, Throughput::ITEMS, [size]() {
+			std::size_t result{0};
+			for (std::size_t i = 0; i < size; ++i)
+				result ^= std::hash<Grid_Direction>{}(Grid_Direction{static_cast<int>(i % 4)});
+			do_not_optimize(result);
+		});
+	}
+}
+
+int main(int argc, char *argv[]) {
+	const Benchmark_Runner runner{argc, argv};
+	bench_readers(runner);
+	bench_algorithms(runner);
+	bench_positions(runner);
+	return 0;
+}
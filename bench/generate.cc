@@ -0,0 +1,369 @@
+#include "common.h"
+#include "bench.h"
+#include <array>
+#include <cmath>
+#include <numeric>
+
+/*
+ * Synthetic input generators. Each generator writes a puzzle input to stdout whose size scales with `n`:
+ *
+ *   01, 02, 04, 07, 09, 12  n lines (calibrations, games, cards, hands, histories, records)
+ *   03, 10, 11, 14, 16, 17  roughly n grid cells
+ *   05                      n seeds
+ *   06                      a single race of time n
+ *   08                      roughly n nodes (at most 26^3)
+ *   13                      n patterns
+ *   15                      n initialization steps
+ */
+
+[[nodiscard]] static std::size_t random_between(std::size_t lo, std::size_t hi) {
+	return std::uniform_int_distribution<std::size_t>{lo, hi}(bench_rng());
+}
+
+[[nodiscard]] static std::size_t grid_side(std::size_t cells) {
+	return std::max<std::size_t>(4, static_cast<std::size_t>(std::sqrt(static_cast<double>(cells))));
+}
+
+static void generate_calibrations(std::size_t n) {
+	static constexpr std::array<const char *, 9> spelled_digits{"one", "two", "three", "four", "five", "six", "seven", "eight", "nine"};
+	for (std::size_t i = 0; i < n; ++i) {
+		std::string line;
+		const auto length = random_between(8, 40);
+		while (line.size() < length) {
+			switch (random_between(0, 5)) {
+			case 0:
+				line += static_cast<char>('1' + random_between(0, 8));
+				break;
+			case 1:
+				line += spelled_digits[random_between(0, 8)];
+				break;
+			default:
+				line += static_cast<char>('a' + random_between(0, 25));
+			}
+		}
+		line[random_between(0, line.size() - 1)] = static_cast<char>('1' + random_between(0, 8));
+		std::cout << line << '\n';
+	}
+}
+
+static void generate_games(std::size_t n) {
+	static constexpr std::array<const char *, 3> colors{"red", "green", "blue"};
+	for (std::size_t id = 1; id <= n; ++id) {
+		std::cout << "Game " << id << ":";
+		const auto num_sets = random_between(1, 6);
+		for (std::size_t set = 0; set < num_sets; ++set) {
+			std::array<std::size_t, 3> order{0, 1, 2};
+			std::ranges::shuffle(order, bench_rng());
+			const auto num_colors = random_between(1, 3);
+			for (std::size_t i = 0; i < num_colors; ++i)
+				std::cout << (i == 0 ? " " : ", ") << random_between(1, 16) << ' ' << colors[order[i]];
+			if (set + 1 < num_sets)
+				std::cout << ';';
+		}
+		std::cout << '\n';
+	}
+}
+
+static void generate_schematic(std::size_t n) {
+	const auto width = std::size_t{140};
+	const auto height = std::max<std::size_t>(1, n / width);
+	for (std::size_t r = 0; r < height; ++r) {
+		std::string row(width, '.');
+		for (std::size_t c = 0; c < width; ) {
+			switch (random_between(0, 9)) {
+			case 0:
+				row[c++] = "*#+$/=%@&-"[random_between(0, 9)];
+				break;
+			case 1:
+			case 2:
+				for (auto digits = random_between(1, 3); digits > 0 && c < width; --digits)
+					row[c++] = static_cast<char>('0' + random_between(1, 9));
+				++c;
+				break;
+			default:
+				++c;
+			}
+		}
+		std::cout << row << '\n';
+	}
+}
+
+static void generate_cards(std::size_t n) {
+	for (std::size_t id = 1; id <= n; ++id) {
+		std::vector<int> numbers(99);
+		std::iota(numbers.begin(), numbers.end(), 1);
+		std::ranges::shuffle(numbers, bench_rng());
+		const auto matches = std::min(random_between(0, 4) == 0 ? random_between(0, 10) : 0, n - id);
+
+		std::cout << "Card " << id << ":";
+		for (std::size_t i = 0; i < 10; ++i)
+			std::cout << ' ' << (numbers[i] < 10 ? " " : "") << numbers[i];
+		std::cout << " |";
+		for (std::size_t i = 0; i < 25; ++i) {
+			const auto number = i < matches ? numbers[i] : numbers[10 + i];
+			std::cout << ' ' << (number < 10 ? " " : "") << number;
+		}
+		std::cout << '\n';
+	}
+}
+
+static void generate_almanac(std::size_t n) {
+	static constexpr std::array<const char *, 7> map_names{"seed-to-soil", "soil-to-fertilizer", "fertilizer-to-water", "water-to-light",
+														   "light-to-temperature", "temperature-to-humidity", "humidity-to-location"};
+	static constexpr std::size_t max_value{std::size_t{1} << 32};
+	std::cout << "seeds:";
+	for (std::size_t i = 0; i < n; ++i)
+		std::cout << ' ' << random_between(0, max_value / 2) << ' ' << random_between(1, max_value / (4 * n + 4));
+	std::cout << "\n\n";
+
+	for (const auto *name : map_names) {
+		std::cout << name << " map:\n";
+		const auto num_converters = random_between(20, 48);
+		std::vector<std::size_t> bounds(num_converters + 1);
+		for (auto &bound : bounds)
+			bound = random_between(0, max_value);
+		std::ranges::sort(bounds);
+		std::vector<std::size_t> destinations(bounds.begin(), std::prev(bounds.end()));
+		std::ranges::shuffle(destinations, bench_rng());
+		for (std::size_t i = 0; i + 1 < bounds.size(); ++i) {
+			if (bounds[i + 1] > bounds[i])
+				std::cout << destinations[i] << ' ' << bounds[i] << ' ' << bounds[i + 1] - bounds[i] << '\n';
+		}
+		std::cout << '\n';
+	}
+}
+
+static void generate_races(std::size_t n) {
+	const auto time = std::max<std::size_t>(n, 4);
+	std::cout << "Time: " << time << '\n';
+	std::cout << "Distance: " << time / 2 * (time - time / 2) - time * time / 8 << '\n';
+}
+
+static void generate_hands(std::size_t n) {
+	static constexpr std::string_view cards{"23456789TJQKA"};
+	for (std::size_t i = 0; i < n; ++i) {
+		std::string hand(5, ' ');
+		for (auto &card : hand)
+			card = cards[random_between(0, cards.size() - 1)];
+		std::cout << hand << ' ' << random_between(1, 1000) << '\n';
+	}
+}
+
+static void generate_network(std::size_t n) {
+	static constexpr std::size_t num_ghosts{6};
+	static constexpr std::size_t max_labels{24 * 26 * 26};
+	/* Ghost g's cycle is g nodes longer than ghost 0's, and all of them must fit in the label space */
+	static constexpr std::size_t max_cycle_length{(max_labels - num_ghosts * (num_ghosts - 1) / 2) / num_ghosts};
+	const auto cycle_length = std::clamp<std::size_t>(n / num_ghosts, 2, max_cycle_length);
+
+	std::string instructions(263, 'L');
+	for (auto &instruction : instructions)
+		instruction = random_between(0, 1) ? 'L' : 'R';
+	std::cout << instructions << "\n\n";
+
+	std::size_t next_label{0};
+	const auto make_label = [&next_label](char last) {
+		std::string label{static_cast<char>('A' + next_label / 26 % 26), static_cast<char>('A' + next_label % 26), last};
+		++next_label;
+		return label;
+	};
+
+	/* Each ghost walks its own cycle one node per step, reaching its Z node exactly every cycle_length + g steps */
+	for (std::size_t ghost = 0; ghost < num_ghosts; ++ghost) {
+		const auto length = cycle_length + ghost;
+		std::vector<std::string> cycle;
+		for (std::size_t i = 0; i + 1 < length; ++i)
+			cycle.push_back(make_label(static_cast<char>('B' + next_label / (26 * 26) % 24)));
+		cycle.push_back(ghost == 0 ? std::string{"ZZZ"} : std::string{'G', static_cast<char>('A' + ghost), 'Z'});
+		const auto start = ghost == 0 ? std::string{"AAA"} : std::string{'G', static_cast<char>('A' + ghost), 'A'};
+
+		std::cout << start << " = (" << cycle[0] << ", " << cycle[0] << ")\n";
+		for (std::size_t i = 0; i < cycle.size(); ++i) {
+			const auto &next = cycle[(i + 1) % cycle.size()];
+			std::cout << cycle[i] << " = (" << next << ", " << next << ")\n";
+		}
+	}
+}
+
+static void generate_histories(std::size_t n) {
+	for (std::size_t i = 0; i < n; ++i) {
+		std::array<long, 5> coefficients{};
+		const auto degree = random_between(0, coefficients.size() - 1);
+		for (std::size_t d = 0; d <= degree; ++d)
+			coefficients[d] = static_cast<long>(random_between(0, 20)) - 10;
+		for (long x = 0; x < 21; ++x) {
+			long value{0};
+			for (auto d = coefficients.size(); d-- > 0; )
+				value = value * x + coefficients[d];
+			std::cout << (x == 0 ? "" : " ") << value;
+		}
+		std::cout << '\n';
+	}
+}
+
+static void generate_pipe_maze(std::size_t n) {
+	auto side = grid_side(n);
+	side += side % 2;
+
+	/* A Hamiltonian cycle: across the top row, snaking back through the remaining rows, then up the first column */
+	std::vector<std::string> grid(side, std::string(side, '.'));
+	grid[0][0] = 'S';
+	for (std::size_t c = 1; c + 1 < side; ++c)
+		grid[0][c] = '-';
+	grid[0][side - 1] = '7';
+	for (std::size_t r = 1; r < side; ++r) {
+		grid[r][0] = '|';
+		for (std::size_t c = 2; c + 1 < side; ++c)
+			grid[r][c] = '-';
+		const bool leftward = r % 2 == 1;
+		grid[r][side - 1] = leftward ? 'J' : '7';
+		grid[r][1] = leftward ? 'F' : 'L';
+	}
+	grid[side - 1][1] = '-';
+	grid[side - 1][0] = 'L';
+	for (const auto &row : grid)
+		std::cout << row << '\n';
+}
+
+static void generate_universe(std::size_t n) {
+	const auto side = grid_side(n);
+	std::vector<bool> empty_rows(side), empty_columns(side);
+	for (std::size_t i = 0; i < side; ++i) {
+		empty_rows[i] = random_between(0, 7) == 0;
+		empty_columns[i] = random_between(0, 7) == 0;
+	}
+	for (std::size_t r = 0; r < side; ++r) {
+		std::string row(side, '.');
+		for (std::size_t c = 0; c < side; ++c) {
+			if (!empty_rows[r] && !empty_columns[c] && random_between(0, 49) == 0)
+				row[c] = '#';
+		}
+		std::cout << row << '\n';
+	}
+}
+
+static void generate_records(std::size_t n) {
+	for (std::size_t i = 0; i < n; ++i) {
+		std::string condition(random_between(6, 20), '.');
+		for (auto &spring : condition)
+			spring = random_between(0, 1) ? '#' : '.';
+
+		std::vector<std::size_t> group_sizes;
+		for (std::size_t c = 0; c < condition.size(); ) {
+			if (condition[c] == '.') {
+				++c;
+				continue;
+			}
+			const auto start = c;
+			while (c < condition.size() && condition[c] == '#')
+				++c;
+			group_sizes.push_back(c - start);
+		}
+		if (group_sizes.empty()) {
+			condition[0] = '#';
+			group_sizes.push_back(1);
+		}
+
+		for (auto &spring : condition) {
+			if (random_between(0, 1))
+				spring = '?';
+		}
+		std::cout << condition;
+		for (std::size_t g = 0; g < group_sizes.size(); ++g)
+			std::cout << (g == 0 ? ' ' : ',') << group_sizes[g];
+		std::cout << '\n';
+	}
+}
+
+static void generate_patterns(std::size_t n) {
+	for (std::size_t i = 0; i < n; ++i) {
+		const auto height = random_between(5, 17), width = random_between(5, 17);
+		std::vector<std::string> pattern(height, std::string(width, '.'));
+		for (auto &row : pattern) {
+			for (auto &cell : row)
+				cell = random_between(0, 1) ? '#' : '.';
+		}
+
+		/* Mirror one side of a random line onto the other, then smudge a reflected cell in half of the patterns */
+		const bool vertical = random_between(0, 1);
+		const auto extent = vertical ? width : height;
+		const auto line = random_between(1, extent - 1);
+		for (std::size_t offset = 0; offset < std::min(line, extent - line); ++offset) {
+			for (std::size_t j = 0; j < (vertical ? height : width); ++j) {
+				auto &source = vertical ? pattern[j][line - 1 - offset] : pattern[line - 1 - offset][j];
+				auto &target = vertical ? pattern[j][line + offset] : pattern[line + offset][j];
+				target = source;
+			}
+		}
+		if (random_between(0, 1)) {
+			auto &cell = vertical ? pattern[random_between(0, height - 1)][line] : pattern[line][random_between(0, width - 1)];
+			cell = cell == '#' ? '.' : '#';
+		}
+
+		for (const auto &row : pattern)
+			std::cout << row << '\n';
+		if (i + 1 < n)
+			std::cout << '\n';
+	}
+}
+
+/* A square grid of cells drawn uniformly from `cells`, so repeating a cell makes it more common */
+static void generate_grid(std::size_t n, std::string_view cells) {
+	const auto side = grid_side(n);
+	for (std::size_t r = 0; r < side; ++r) {
+		std::string row(side, '.');
+		for (auto &cell : row)
+			cell = cells[random_between(0, cells.size() - 1)];
+		std::cout << row << '\n';
+	}
+}
+
+static void generate_initialization_steps(std::size_t n) {
+	for (std::size_t i = 0; i < n; ++i) {
+		std::string label(random_between(2, 6), 'a');
+		for (auto &letter : label)
+			letter = static_cast<char>('a' + random_between(0, 25));
+		std::cout << (i == 0 ? "" : ",") << label;
+		if (random_between(0, 2) == 0)
+			std::cout << '-';
+		else
+			std::cout << '=' << random_between(1, 9);
+	}
+	std::cout << '\n';
+}
+
+int main(int argc, char *argv[]) {
+	if (argc < 3) {
+		std::cerr << "Usage: " << argv[0] << " <day> <n> [seed]" << std::endl;
+		return 1;
+	}
+	const auto day = std::stoi(argv[1]);
+	const auto n = std::stoul(argv[2]);
+	if (argc > 3)
+		bench_rng().seed(std::stoul(argv[3]));
+
+	std::ios_base::sync_with_stdio(false);
+	switch (day) {
+	case 1: generate_calibrations(n); break;
+	case 2: generate_games(n); break;
+	case 3: generate_schematic(n); break;
+	case 4: generate_cards(n); break;
+	case 5: generate_almanac(n); break;
+	case 6: generate_races(n); break;
+	case 7: generate_hands(n); break;
+	case 8: generate_network(n); break;
+	case 9: generate_histories(n); break;
+	case 10: generate_pipe_maze(n); break;
+	case 11: generate_universe(n); break;
+	case 12: generate_records(n); break;
+	case 13: generate_patterns(n); break;
+	case 14: generate_grid(n, ".......OO#"); break;
+	case 15: generate_initialization_steps(n); break;
+	case 16: generate_grid(n, ".........../\\|-"); break;
+	case 17: generate_grid(n, "123456789"); break;
+	default:
+		std::cerr << argv[0] << ": no generator for day " << argv[1] << std::endl;
+		return 1;
+	}
+	return 0;
+}
@@ -1,42 +1,223 @@
 #include "common.h"
 #include <algorithm>
+#include <bit>
+#include <cstdint>
 #include <numeric>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <thread>
+#include <unistd.h>
+#if defined(__AVX2__) || defined(__SSE2__)
+#include <immintrin.h>
+#endif
 
-[[nodiscard]] static uint parse_calibration_simple(const std::string &line) {
-	return std::stoi(std::string{} + *std::ranges::find_if(line, Is_Digit{}) + *std::ranges::find_if(line.rbegin(), line.rend(), Is_Digit{}));
+static constexpr std::array<std::string_view, 9> spelled_digits{"one", "two", "three", "four", "five", "six", "seven", "eight", "nine"};
+
+[[nodiscard]] static constexpr uint parse_calibration_simple(std::string_view line) {
+	return (*std::ranges::find_if(line, Is_Digit{}) - '0') * 10 + (*std::ranges::find_if(line.rbegin(), line.rend(), Is_Digit{}) - '0');
 }
 
-[[nodiscard]] static uint parse_calibration_advanced(const std::string &line) {
-	static constexpr std::array<std::string, 9> spelled_digits{"one", "two", "three", "four", "five", "six", "seven", "eight", "nine"};
+/*
+ * Aho-Corasick automaton over the spelled digits, flattened into a DFA at compile time. The reversed automaton matches
+ * the reversed words so the last digit is found by scanning backwards. Since no spelled digit occurs inside another,
+ * the first match to end is also the first to start, so each scan stops at its first match and touches every byte at
+ * most once.
+ */
+template<bool ReversedV>
+struct Digit_Automaton {
+	constexpr Digit_Automaton() {
+		std::size_t num_states{1};
+		for (std::size_t digit = 0; digit < spelled_digits.size(); ++digit) {
+			const auto word = spelled_digits[digit];
+			std::size_t state{0};
+			for (std::size_t i = 0; i < word.size(); ++i) {
+				auto &next = transitions_[state][(ReversedV ? word[word.size() - 1 - i] : word[i]) - 'a'];
+				if (next == 0)
+					next = num_states++;
+				state = next;
+			}
+			outputs_[state] = digit + 1;
+		}
 
-	auto first_it = std::ranges::find_if(line, Is_Digit{});
-	auto second_it = std::ranges::find_if(line.rbegin(), line.rend(), Is_Digit{});
-	auto first_value = *first_it;
-	auto second_value = *second_it;
-	for (auto spelled_digit_it = spelled_digits.begin(); spelled_digit_it != spelled_digits.end(); ++spelled_digit_it) {
-		if (auto it = std::ranges::search(line, *spelled_digit_it).begin(); it < first_it) {
-			first_it = it;
-			first_value = '0' + std::distance(spelled_digits.begin(), spelled_digit_it) + 1;
+		std::array<std::uint8_t, max_states> failures{}, queue{};
+		std::size_t queue_start{0}, queue_end{0};
+		for (auto next : transitions_[0]) {
+			if (next != 0)
+				queue[queue_end++] = next;
+		}
+		while (queue_start != queue_end) {
+			const auto state = queue[queue_start++];
+			if (outputs_[state] == 0)
+				outputs_[state] = outputs_[failures[state]];
+			for (std::size_t letter = 0; letter < alphabet_size; ++letter) {
+				auto &next = transitions_[state][letter];
+				if (next != 0) {
+					failures[next] = transitions_[failures[state]][letter];
+					queue[queue_end++] = next;
+				} else {
+					next = transitions_[failures[state]][letter];
+				}
+			}
 		}
-		if (auto it = std::ranges::search(line.rbegin(), line.rend(), spelled_digit_it->rbegin(), spelled_digit_it->rend()).begin(); it < second_it) {
-			second_it = it;
-			second_value = '0' + std::distance(spelled_digits.begin(), spelled_digit_it) + 1;
+	}
+
+	/* Value of the first digit or spelled digit in the line, or the last one for the reversed automaton */
+	[[nodiscard]] constexpr uint first_digit(std::string_view line) const noexcept {
+		std::uint8_t state{0};
+		for (std::size_t i = 0; i < line.size(); ++i) {
+			const auto c = line[ReversedV ? line.size() - 1 - i : i];
+			if (is_digit(c))
+				return c - '0';
+			state = 'a' <= c && c <= 'z' ? transitions_[state][c - 'a'] : 0;
+			if (outputs_[state] != 0)
+				return outputs_[state];
 		}
+		return 0;
 	}
-	return std::stoi(std::string{} + first_value + second_value);
+
+private:
+	static constexpr std::size_t alphabet_size{26};
+	static constexpr std::size_t max_states{1 + [] {
+		std::size_t letters{0};
+		for (auto word : spelled_digits)
+			letters += word.size();
+		return letters;
+	}()};
+
+	std::array<std::array<std::uint8_t, alphabet_size>, max_states> transitions_{};
+	std::array<std::uint8_t, max_states> outputs_{};
+};
+
+static constexpr Digit_Automaton<false> forward_digit_automaton{};
+static constexpr Digit_Automaton<true> reverse_digit_automaton{};
+
+[[nodiscard]] static constexpr uint parse_calibration_advanced(std::string_view line) {
+	return forward_digit_automaton.first_digit(line) * 10 + reverse_digit_automaton.first_digit(line);
+}
+
+#ifndef ADVENT_EMBEDDED_INPUT
+/*
+ * Bulk part 1 scanner. Vector compares locate the digits and newlines in each block so that only those bytes are
+ * visited; the first and last digit of the line in progress carry over between calls, so input can be fed in
+ * arbitrary pieces.
+ */
+struct Calibration_Scanner {
+	void scan(const char *data, std::size_t size) noexcept {
+		std::size_t i{0};
+#if defined(__AVX2__)
+		for (; i + 32 <= size; i += 32) {
+			const auto block = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(data + i));
+			const auto offsets = _mm256_sub_epi8(block, _mm256_set1_epi8('0'));
+			const auto digits = _mm256_cmpeq_epi8(_mm256_min_epu8(offsets, _mm256_set1_epi8(9)), offsets);
+			const auto newlines = _mm256_cmpeq_epi8(block, _mm256_set1_epi8('\n'));
+			visit_block(data + i, static_cast<std::uint32_t>(_mm256_movemask_epi8(_mm256_or_si256(digits, newlines))));
+		}
+#elif defined(__SSE2__)
+		for (; i + 16 <= size; i += 16) {
+			const auto block = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + i));
+			const auto offsets = _mm_sub_epi8(block, _mm_set1_epi8('0'));
+			const auto digits = _mm_cmpeq_epi8(_mm_min_epu8(offsets, _mm_set1_epi8(9)), offsets);
+			const auto newlines = _mm_cmpeq_epi8(block, _mm_set1_epi8('\n'));
+			visit_block(data + i, static_cast<std::uint32_t>(_mm_movemask_epi8(_mm_or_si128(digits, newlines))));
+		}
+#endif
+		for (; i < size; ++i)
+			visit(data[i]);
+	}
+
+	[[nodiscard]] std::size_t finish() noexcept {
+		end_line();
+		return sum_;
+	}
+
+private:
+	static constexpr uint no_digit{~0u};
+
+	uint first_{no_digit}, last_{0};
+	std::size_t sum_{0};
+
+	void visit_block(const char *block, std::uint32_t mask) noexcept {
+		for (; mask != 0; mask &= mask - 1)
+			visit(block[std::countr_zero(mask)]);
+	}
+
+	void visit(char c) noexcept {
+		if (c == '\n') {
+			end_line();
+		} else if (is_digit(c)) {
+			if (first_ == no_digit)
+				first_ = c - '0';
+			last_ = c - '0';
+		}
+	}
+
+	void end_line() noexcept {
+		if (first_ != no_digit)
+			sum_ += first_ * 10 + last_;
+		first_ = no_digit;
+	}
+};
+
+/* Splits the input at line boundaries into one chunk per thread and scans the chunks concurrently */
+[[nodiscard]] static std::size_t scan_calibration_values(std::string_view in) {
+	static constexpr std::size_t min_chunk_size{std::size_t{1} << 22};
+	const auto num_chunks = std::clamp<std::size_t>(in.size() / min_chunk_size, 1, std::max(1u, std::thread::hardware_concurrency()));
+
+	std::vector<std::size_t> sums(num_chunks);
+	std::vector<std::jthread> threads;
+	for (std::size_t chunk = 0, start = 0; chunk < num_chunks; ++chunk) {
+		auto end = chunk + 1 == num_chunks ? in.size() : in.find('\n', std::max(start, in.size() * (chunk + 1) / num_chunks));
+		end = end == std::string_view::npos ? in.size() : std::min(end + 1, in.size());
+		threads.emplace_back([&sums, chunk, lines = in.substr(start, end - start)] {
+			Calibration_Scanner scanner;
+			scanner.scan(lines.data(), lines.size());
+			sums[chunk] = scanner.finish();
+		});
+		start = end;
+	}
+	threads.clear();
+	return std::reduce(sums.begin(), sums.end());
+}
+
+/* Maps stdin when it is a regular file, otherwise scans it through a fixed-size buffer */
+[[nodiscard]] static std::size_t scan_calibration_values_from_stdin() {
+	struct stat status{};
+	if (fstat(STDIN_FILENO, &status) == 0 && S_ISREG(status.st_mode) && status.st_size > 0) {
+		const auto size = static_cast<std::size_t>(status.st_size);
+		if (auto *data = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, STDIN_FILENO, 0); data != MAP_FAILED) {
+			madvise(data, size, MADV_SEQUENTIAL);
+			const auto sum = scan_calibration_values(std::string_view{static_cast<const char *>(data), size});
+			munmap(data, size);
+			return sum;
+		}
+	}
+
+	Calibration_Scanner scanner;
+	std::vector<char> buffer(std::size_t{1} << 20);
+	while (std::cin.read(buffer.data(), static_cast<std::streamsize>(buffer.size())) || std::cin.gcount() > 0)
+		scanner.scan(buffer.data(), static_cast<std::size_t>(std::cin.gcount()));
+	return scanner.finish();
 }
+#endif
 
 template<typename ParserT>
-[[nodiscard]] static std::vector<uint> read_calibration_values(std::istream &in, const ParserT &parser) {
-	const auto lines = read_lines(in);
-	std::vector<uint> values(lines.size());
-	std::ranges::transform(lines, values.begin(), parser);
-	return values;
+[[nodiscard]] static constexpr uint sum_calibration_values(std::string_view in, const ParserT &parser) {
+	uint sum{0};
+	foreach_line(in, [&sum, &parser](auto line) { sum += parser(line); });
+	return sum;
 }
 
 int main(int argc, char *argv[]) {
 	const auto part = select_part(argc, argv);
-	const auto values = read_calibration_values(std::cin, part == 1 ? parse_calibration_simple : parse_calibration_advanced);
-	std::cout << std::reduce(values.begin(), values.end()) << std::endl;
+#ifdef ADVENT_EMBEDDED_INPUT
+	static constexpr std::array answers{sum_calibration_values(embedded_input, parse_calibration_simple),
+										sum_calibration_values(embedded_input, parse_calibration_advanced)};
+	std::cout << answers[part - 1] << std::endl;
+#else
+	if (part == 1)
+		std::cout << scan_calibration_values_from_stdin() << std::endl;
+	else
+		std::cout << accumulate_lines(std::cin, 0u, [](auto sum, const auto &line) { return sum + parse_calibration_advanced(line); }) << std::endl;
+#endif
 	return 0;
 }
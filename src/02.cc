@@ -1,103 +1,84 @@
 #include "common.h"
-#include <numeric>
-
-struct Game_Round : Token_Reader<Game_Round, ':'> {
-	enum class Color { RED, GREEN, BLUE };
-
-	struct Set : Token_Reader<Set, ','> {
-		struct Dice_Count : Token_Reader<Dice_Count> {
-			[[nodiscard]] int count() const noexcept {
-				return count_;
-			}
-
-			[[nodiscard]] Color color() const noexcept {
-				return color_;
-			}
-
-			void read_token(const std::string &token) final {
-				switch (token_num()) {
-				case 1:
-					count_ = std::stoi(token);
-					break;
-				case 2:
-					if (token == "red")
-						color_ = Color::RED;
-					else if (token == "green")
-						color_ = Color::GREEN;
-					else if (token == "blue")
-						color_ = Color::BLUE;
-					else
-						throw std::logic_error{"Parse error: expected a valid color"};
-					break;
-				}
-			}
-		private:
-			int count_{};
-			Color color_{};
-		};
-
-		[[nodiscard]] int color_count(Color color) const noexcept {
-			const auto it = dice_counts_.find(color);
-			return it != dice_counts_.end() ? dice_counts_.at(color).count() : 0;
+#include <array>
+#include <limits>
+
+struct Game_Round {
+	enum Color { RED, GREEN, BLUE, NUM_COLORS };
+	using Dice_Counts = std::array<int, NUM_COLORS>;
+
+	static constexpr Dice_Counts no_limits{std::numeric_limits<int>::max(), std::numeric_limits<int>::max(), std::numeric_limits<int>::max()};
+
+	/* Parses a game in one pass, keeping only the largest count revealed for each color. Parsing stops as soon as a
+	 * count exceeds its limit, after which only is_possible() is meaningful. */
+	[[nodiscard]] static Game_Round create_from_view(std::string_view line, const Dice_Counts &limits = no_limits) {
+		Game_Round game;
+		const auto colon = line.find(':');
+		const auto id_start = line.find(' ') + 1;
+		game.id_ = parse_integer<int>(line.substr(id_start, colon - id_start));
+		for (auto rest = line.substr(std::min(colon + 1, line.size())); !rest.empty(); ) {
+			const auto count = parse_integer<int>(rest);
+			const auto color_start = rest.find_first_not_of(" 0123456789");
+			if (color_start == std::string_view::npos)
+				throw std::logic_error{"Parse error: expected a valid color"};
+			const auto color = parse_color(rest[color_start]);
+			game.max_counts_[color] = std::max(game.max_counts_[color], count);
+			if (count > limits[color])
+				break;
+
+			const auto next = rest.find_first_of(",;", color_start);
+			rest.remove_prefix(next == std::string_view::npos ? rest.size() : next + 1);
 		}
-
-		void read_token(const std::string &token) final {
-			const auto dice_count = Dice_Count::create_from_string(token);
-			dice_counts_[dice_count.color()] = dice_count;
-		}
-
-	private:
-		std::unordered_map<Color, Dice_Count> dice_counts_;
-	};
+		return game;
+	}
 
 	[[nodiscard]] int id() const noexcept {
 		return id_;
 	}
 
-	[[nodiscard]] bool is_possible(int red_count, int green_count, int blue_count) const noexcept {
-		return std::ranges::all_of(set_list_, [red_count, green_count, blue_count](const auto &set) {
-			return set.color_count(Color::RED) <= red_count
-				&& set.color_count(Color::GREEN) <= green_count
-				&& set.color_count(Color::BLUE) <= blue_count;
-		});
+	[[nodiscard]] bool is_possible(const Dice_Counts &limits) const noexcept {
+		for (std::size_t color = 0; color < NUM_COLORS; ++color) {
+			if (max_counts_[color] > limits[color])
+				return false;
+		}
+		return true;
 	}
 
 	[[nodiscard]] int min_possible(Color color) const noexcept {
-		return std::ranges::max_element(set_list_, [color](const auto &lhs, const auto &rhs) { return lhs.color_count(color) < rhs.color_count(color); })->color_count(color);
+		return max_counts_[color];
 	}
 
 	[[nodiscard]] int min_possible_power() const noexcept {
-		return min_possible(Color::RED) * min_possible(Color::GREEN) * min_possible(Color::BLUE);
-	}
-
-	void read_token(const std::string &token) final {
-		if (token_num() == 0) {
-			auto id_start = token.find(' ') + 1;
-			auto id_end = token.find(':', id_start + 1);
-			id_ = std::stoi(token.substr(id_start, id_end - id_start));
-		} else {
-			set_list_ = read_tokens(token, ';', [](const std::string &token) { return Set::create_from_string(token); });
-		}
+		return min_possible(RED) * min_possible(GREEN) * min_possible(BLUE);
 	}
 
 private:
 	int id_{};
-	std::vector<Set> set_list_;
+	Dice_Counts max_counts_{};
+
+	[[nodiscard]] static Color parse_color(char first_letter) {
+		switch (first_letter) {
+		case 'r':
+			return RED;
+		case 'g':
+			return GREEN;
+		case 'b':
+			return BLUE;
+		default:
+			throw std::logic_error{"Parse error: expected a valid color"};
+		}
+	}
 };
 
+static constexpr Game_Round::Dice_Counts bag{12, 13, 14};
+
 int main(int argc, char *argv[]) {
 	const auto part = select_part(argc, argv);
-
-	std::vector<Game_Round> game_rounds;
-	while (has_input(std::cin))
-		game_rounds.push_back(Game_Round::create_from_stream(std::cin));
-
-	std::cout << std::accumulate(game_rounds.begin(), game_rounds.end(), 0,
-		part == 1 ? [](std::size_t sum, const Game_Round &game) {
-			return sum + (game.is_possible(12, 13, 14) ? game.id() : 0);
-		} : [](std::size_t sum, const Game_Round &game) {
-			return sum + game.min_possible_power();
+	std::cout << accumulate_lines(std::cin, std::size_t{0}, [part](auto sum, const auto &line) {
+		if (part == 1) {
+			const auto game = Game_Round::create_from_view(line, bag);
+			return sum + (game.is_possible(bag) ? game.id() : 0);
 		}
-	) << std::endl;
+		return sum + Game_Round::create_from_view(line).min_possible_power();
+	}) << std::endl;
 	return 0;
 }
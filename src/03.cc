@@ -1,87 +1,218 @@
 #include "common.h"
+#include <array>
+#include <bit>
 #include <cstdint>
-#include <numeric>
+#include <limits>
 
-struct Engine_Schematic : Paragraph_Reader<Engine_Schematic> {
+/* One bit per column of a schematic row */
+struct Bit_Row {
+	using Word = std::uint64_t;
+	static constexpr std::size_t word_bits{64};
+
+	explicit Bit_Row(std::size_t width) : words_((width + word_bits - 1) / word_bits) { }
+
+	/* Clears the row, keeping its storage */
+	void reset(std::size_t width) {
+		words_.assign((width + word_bits - 1) / word_bits, 0);
+	}
+
+	void set(std::size_t column) noexcept {
+		words_[column / word_bits] |= Word{1} << (column % word_bits);
+	}
+
+	Bit_Row &operator|=(const Bit_Row &other) noexcept {
+		for (std::size_t w = 0; w < words_.size(); ++w)
+			words_[w] |= other.words_[w];
+		return *this;
+	}
+
+	/* Also sets both neighbours of every set column, so that a symbol covers the columns diagonal to it */
+	[[nodiscard]] Bit_Row dilated() const {
+		Bit_Row result{*this};
+		for (std::size_t w = 0; w < words_.size(); ++w) {
+			result.words_[w] |= words_[w] << 1 | words_[w] >> 1;
+			if (w > 0)
+				result.words_[w] |= words_[w - 1] >> (word_bits - 1);
+			if (w + 1 < words_.size())
+				result.words_[w] |= words_[w + 1] << (word_bits - 1);
+		}
+		return result;
+	}
 
-	[[nodiscard]] std::vector<int> part_numbers() const {
-		std::vector<int> numbers{};
-		for (const auto &[number, position] : number_positions_) {
-			if (touches_symbols(number, position))
-				numbers.push_back(number);
+	[[nodiscard]] bool any_in(std::size_t first, std::size_t last) const noexcept {
+		for (auto w = first / word_bits; w * word_bits < last; ++w) {
+			if (words_[w] & range_mask(w, first, last))
+				return true;
 		}
-		return numbers;
+		return false;
 	}
 
-	[[nodiscard]] std::vector<int> gear_ratios() const {
-		std::unordered_map<Grid_Position, std::vector<int>> star_adjacent_parts;
-		for (const auto &[number, position] : number_positions_) {
-			for (const auto &star_position : adjacent_symbols(number, position, '*'))
-				star_adjacent_parts[star_position].push_back(number);
+	/* Calls func with every set column in [first, last) */
+	template<typename FuncT>
+	void foreach_in(std::size_t first, std::size_t last, FuncT func) const {
+		for (auto w = first / word_bits; w * word_bits < last; ++w) {
+			for (auto word = words_[w] & range_mask(w, first, last); word != 0; word &= word - 1)
+				func(w * word_bits + static_cast<std::size_t>(std::countr_zero(word)));
 		}
+	}
 
-		std::vector<int> ratios;
-		for (const auto &[position, parts] : star_adjacent_parts) {
-			if (parts.size() == 2)
-				ratios.push_back(parts[0] * parts[1]);
+	/* Precomputes the prefix counts used by rank() and returns the number of set columns */
+	std::size_t index() {
+		word_ranks_.resize(words_.size());
+		std::size_t count{0};
+		for (std::size_t w = 0; w < words_.size(); ++w) {
+			word_ranks_[w] = count;
+			count += static_cast<std::size_t>(std::popcount(words_[w]));
 		}
-		return ratios;
+		return count;
+	}
+
+	/* Number of set columns before column, valid after index() */
+	[[nodiscard]] std::size_t rank(std::size_t column) const noexcept {
+		const auto w = column / word_bits;
+		return word_ranks_[w] + static_cast<std::size_t>(std::popcount(words_[w] & ((Word{1} << (column % word_bits)) - 1)));
+	}
+
+private:
+	std::vector<Word> words_;
+	std::vector<std::size_t> word_ranks_;
+
+	/* Bits of word w that fall in [first, last) */
+	[[nodiscard]] static Word range_mask(std::size_t w, std::size_t first, std::size_t last) noexcept {
+		const auto word_start = w * word_bits;
+		auto mask = ~Word{0};
+		if (first > word_start)
+			mask &= ~Word{0} << (first - word_start);
+		if (last < word_start + word_bits)
+			mask &= ~(~Word{0} << (last - word_start));
+		return mask;
+	}
+};
+
+/* Streams the schematic through a window of three rows, settling each row's numbers once the row below it is read
+ * and each row's stars once the numbers of the row below them are settled */
+struct Engine_Schematic : Paragraph_Reader<Engine_Schematic> {
+
+	[[nodiscard]] long part_number_sum() const noexcept {
+		return part_number_sum_;
+	}
+
+	[[nodiscard]] long gear_ratio_sum() const noexcept {
+		return gear_ratio_sum_;
 	}
 
 	void read_line(const std::string &line) final {
-		std::string current_nunber;
-		std::vector<char> symbol_row(line.size(), ' ');
-		for (std::size_t column_idx = 0; column_idx < line.size(); ++column_idx) {
-			if (is_digit(line[column_idx])) {
-				current_nunber += line[column_idx];
-			} else {
-				if (!current_nunber.empty()) {
-					number_positions_.emplace_back(std::stoi(current_nunber), Grid_Position{line_num(), column_idx - current_nunber.size()});
-					current_nunber.clear();
+		if (num_rows_ == 0)
+			width_ = line.size();
+		else if (line.size() != width_)
+			throw std::logic_error{"Parse error: schematic rows differ in width"};
+
+		window_[num_rows_ % window_.size()].parse(line);
+		++num_rows_;
+		if (num_rows_ >= 2)
+			settle_numbers(num_rows_ - 2);
+		if (num_rows_ >= 3)
+			settle_stars(num_rows_ - 3);
+	}
+
+	void read_end() final {
+		if (num_rows_ >= 1)
+			settle_numbers(num_rows_ - 1);
+		for (auto row = num_rows_ >= 2 ? num_rows_ - 2 : 0; row < num_rows_; ++row)
+			settle_stars(row);
+	}
+
+private:
+	/* A run of digits covering columns [first, last) */
+	struct Part_Number {
+		std::size_t first, last;
+		long value;
+	};
+
+	struct Window_Row {
+		Bit_Row symbols{0}, stars{0};
+		std::vector<Part_Number> numbers;
+		std::vector<std::uint8_t> star_counts;
+		std::vector<long> star_products;
+
+		void parse(const std::string &line) {
+			symbols.reset(line.size());
+			stars.reset(line.size());
+			numbers.clear();
+			for (std::size_t column = 0; column < line.size(); ) {
+				if (is_digit(line[column])) {
+					Part_Number number{column, column, 0};
+					for (; number.last < line.size() && is_digit(line[number.last]); ++number.last) {
+						number.value = number.value * 10 + (line[number.last] - '0');
+						if (number.value > std::numeric_limits<int>::max())
+							throw std::logic_error{"Parse error: part number out of range"};
+					}
+					numbers.push_back(number);
+					column = number.last;
+					continue;
 				}
-				if (is_symbol(line[column_idx]))
-					symbol_row[column_idx] = line[column_idx];
+				if (is_symbol(line[column]))
+					symbols.set(column);
+				if (line[column] == '*')
+					stars.set(column);
+				++column;
 			}
+			const auto num_stars = stars.index();
+			star_counts.assign(num_stars, 0);
+			star_products.assign(num_stars, 1);
 		}
-		if (!current_nunber.empty())
-			number_positions_.emplace_back(std::stoi(current_nunber), Grid_Position{line_num(), line.size() - current_nunber.size()});
-		symbol_map_.push_back(std::move(symbol_row));
+	};
+
+	std::size_t width_{0};
+	std::size_t num_rows_{0};
+	std::array<Window_Row, 3> window_;
+	long part_number_sum_{0};
+	long gear_ratio_sum_{0};
+
+	/* Rows whose contents can touch row: itself and whichever of its neighbours exist */
+	[[nodiscard]] std::pair<std::size_t, std::size_t> neighbour_rows(std::size_t row) const noexcept {
+		return {row > 0 ? row - 1 : 0, std::min(row + 2, num_rows_)};
 	}
 
-private:
-	std::vector<std::vector<char>> symbol_map_;
-	std::vector<std::pair<int, Grid_Position>> number_positions_;
-
-	[[nodiscard]] bool touches_symbols(int number, const Grid_Position &position) const noexcept {
-		const auto width = count_digits(number);
-		for (auto column_index = position.c > 0 ? position.c - 1 : 0; column_index <= std::min(position.c + width, symbol_map_[position.r].size() - 1); ++column_index) {
-			if ((position.r > 0 && symbol_map_[position.r - 1][column_index] != ' ')
-				|| symbol_map_[position.r][column_index] != ' '
-				|| (position.r < symbol_map_.size() - 1 && symbol_map_[position.r + 1][column_index] != ' '))
-				return true;
+	/* Requires the rows directly above and below to still be in the window */
+	void settle_numbers(std::size_t row) {
+		const auto [first_row, last_row] = neighbour_rows(row);
+		Bit_Row near_symbols{window_[first_row % window_.size()].symbols};
+		for (auto neighbour = first_row + 1; neighbour < last_row; ++neighbour)
+			near_symbols |= window_[neighbour % window_.size()].symbols;
+		near_symbols = near_symbols.dilated();
+
+		for (const auto &number : window_[row % window_.size()].numbers) {
+			if (near_symbols.any_in(number.first, number.last))
+				part_number_sum_ += number.value;
+
+			const auto first = number.first > 0 ? number.first - 1 : 0;
+			const auto last = std::min(number.last + 1, width_);
+			for (auto neighbour = first_row; neighbour < last_row; ++neighbour) {
+				auto &window_row = window_[neighbour % window_.size()];
+				window_row.stars.foreach_in(first, last, [&window_row, &number](std::size_t column) {
+					const auto star = window_row.stars.rank(column);
+					if (window_row.star_counts[star] < 2)
+						window_row.star_products[star] *= number.value;
+					window_row.star_counts[star] = static_cast<std::uint8_t>(std::min(window_row.star_counts[star] + 1, 3));
+				});
+			}
 		}
-		return false;
 	}
 
-	[[nodiscard]] std::vector<Grid_Position> adjacent_symbols(int number, const Grid_Position &position, char symbol) const noexcept {
-		std::vector<Grid_Position> symbol_positions;
-		const auto width = count_digits(number);
-		for (auto column_index = position.c > 0 ? position.c - 1 : 0; column_index <= std::min(position.c + width, symbol_map_[position.r].size() - 1); ++column_index) {
-			if (position.r > 0 && symbol_map_[position.r - 1][column_index] == symbol)
-				symbol_positions.push_back(Grid_Position{position.r - 1, column_index});
-			if (symbol_map_[position.r][column_index] == symbol)
-				symbol_positions.push_back(Grid_Position{position.r, column_index});
-			if (position.r < symbol_map_.size() - 1 && symbol_map_[position.r + 1][column_index] == symbol)
-				symbol_positions.push_back(Grid_Position{position.r + 1, column_index});
+	/* Requires the numbers of the rows directly above and below to be settled */
+	void settle_stars(std::size_t row) {
+		const auto &window_row = window_[row % window_.size()];
+		for (std::size_t star = 0; star < window_row.star_counts.size(); ++star) {
+			if (window_row.star_counts[star] == 2 && __builtin_add_overflow(gear_ratio_sum_, window_row.star_products[star], &gear_ratio_sum_))
+				throw std::overflow_error{"Gear ratio sum exceeds 64 bits"};
 		}
-		return symbol_positions;
 	}
 };
 
 int main(int argc, char *argv[]) {
 	const auto part = select_part(argc, argv);
-	auto schematic = Engine_Schematic::create_from_stream(std::cin);
-	auto values = part == 1 ? schematic.part_numbers() : schematic.gear_ratios();
-	std::cout << std::accumulate(values.begin(), values.end(), 0, [](int sum, int number) { return sum + number; }) << std::endl;
+	const auto schematic = Engine_Schematic::create_from_stream(std::cin);
+	std::cout << (part == 1 ? schematic.part_number_sum() : schematic.gear_ratio_sum()) << std::endl;
 	return 0;
 }
@@ -1,70 +1,120 @@
 #include "common.h"
 #include <algorithm>
-#include <numeric>
-#include <unordered_set>
+#include <bitset>
 
 struct Card : Token_Reader<Card, ':'> {
 
-	struct Number_Set : Token_Reader<Number_Set> {
-		[[nodiscard]] bool contains(int number) const noexcept {
-			return numbers_.contains(number);
-		}
+	/* Numbers below mask_bits live in a bitmask, so most intersections are one AND and a popcount. Any larger
+	 * numbers fall back to a sorted list. */
+	struct Number_Set {
+		static constexpr std::size_t mask_bits{128};
 
-		[[nodiscard]] const std::unordered_set<int> &set() const noexcept {
-			return numbers_;
+		[[nodiscard]] static Number_Set create_from_view(std::string_view numbers) {
+			Number_Set set;
+			for (auto start = numbers.find_first_not_of(' '); start != std::string_view::npos; start = numbers.find_first_not_of(' ', start)) {
+				const auto end = std::min(numbers.find(' ', start), numbers.size());
+				const auto number = parse_integer<int>(numbers.substr(start, end - start));
+				if (0 <= number && static_cast<std::size_t>(number) < mask_bits)
+					set.small_.set(static_cast<std::size_t>(number));
+				else
+					set.large_.push_back(number);
+				start = end;
+			}
+			std::ranges::sort(set.large_);
+			const auto duplicates = std::ranges::unique(set.large_);
+			set.large_.erase(duplicates.begin(), duplicates.end());
+			return set;
 		}
 
-		void read_token(const std::string &token) final {
-			if (!token.empty())
-				numbers_.insert(std::stoi(token));
+		[[nodiscard]] std::size_t count_common(const Number_Set &other) const noexcept {
+			auto common = (small_ & other.small_).count();
+			for (auto lhs = large_.begin(), rhs = other.large_.begin(); lhs != large_.end() && rhs != other.large_.end(); ) {
+				if (*lhs < *rhs) {
+					++lhs;
+				} else if (*rhs < *lhs) {
+					++rhs;
+				} else {
+					++common;
+					++lhs;
+					++rhs;
+				}
+			}
+			return common;
 		}
+
 	private:
-		std::unordered_set<int> numbers_;
+		std::bitset<mask_bits> small_;
+		std::vector<int> large_;
 	};
 
-	[[nodiscard]] std::size_t num_matches() const {
-		return std::ranges::count_if(your_numbers_.set(),
-									 [this](auto number) { return winning_numbers_.contains(number); });
+	[[nodiscard]] std::size_t num_matches() const noexcept {
+		return num_matches_;
 	}
 
-	[[nodiscard]] std::size_t points() const {
-		const auto matches = num_matches();
-		return matches == 0 ? matches : 1 << (matches - 1);
+	[[nodiscard]] std::size_t points() const noexcept {
+		return num_matches_ == 0 ? 0 : std::size_t{1} << (num_matches_ - 1);
 	}
 
 	void read_token(const std::string &token) final {
 		switch (token_num()) {
 		case 1:
-			auto number_sets = read_tokens(token, '|', [](const auto &token) { return Number_Set::create_from_string(token); });
-			winning_numbers_ = std::move(number_sets[0]);
-			your_numbers_ = std::move(number_sets[1]);
+			const auto separator = token.find('|');
+			if (separator == std::string::npos)
+				throw std::logic_error{"Parse error: expected '|' between number sets"};
+			const std::string_view numbers{token};
+			const auto winning_numbers = Number_Set::create_from_view(numbers.substr(0, separator));
+			const auto your_numbers = Number_Set::create_from_view(numbers.substr(separator + 1));
+			num_matches_ = winning_numbers.count_common(your_numbers);
 			break;
 		}
 	}
 
 private:
-	Number_Set winning_numbers_, your_numbers_;
+	std::size_t num_matches_{0};
 };
 
-[[nodiscard]] static std::size_t total_points(const std::vector<Card> &cards) {
-	return std::accumulate(cards.begin(), cards.end(), 0ul,
-						   [](auto sum, const auto &card) { return sum + card.points(); });
-}
+/* Counts card instances while streaming: copies won by earlier cards are a running total, and a ring buffer
+ * difference array records where each win runs out. The ring only reaches as far ahead as the largest match count
+ * seen so far. */
+struct Card_Copies {
+	/* Returns the number of instances of the next card, which has the given number of matches */
+	std::size_t add(std::size_t matches) {
+		if (matches + 1 > expiring_.size())
+			grow(std::max(matches + 1, 2 * expiring_.size()));
 
-[[nodiscard]] static std::size_t total_cards(const std::vector<Card> &cards) {
-	std::vector<std::size_t> counts(cards.size(), 1);
-	for (std::size_t i = 0; i < cards.size(); ++i) {
-		for (std::size_t j = i + 1; j < i + 1 + cards[i].num_matches(); ++j)
-			counts[j] += counts[i];
+		auto &expiring = expiring_[card_ % expiring_.size()];
+		won_ -= expiring;
+		expiring = 0;
+
+		const auto instances = 1 + won_;
+		if (matches > 0) {
+			won_ += instances;
+			expiring_[(card_ + matches + 1) % expiring_.size()] += instances;
+		}
+		++card_;
+		return instances;
 	}
-	return std::accumulate(counts.begin(), counts.end(), 0ul);
-}
+
+private:
+	std::size_t card_{0};
+	std::size_t won_{0};
+	std::vector<std::size_t> expiring_;
+
+	void grow(std::size_t size) {
+		std::vector<std::size_t> expiring(size);
+		for (auto card = card_; card < card_ + expiring_.size(); ++card)
+			expiring[card % size] = expiring_[card % expiring_.size()];
+		expiring_ = std::move(expiring);
+	}
+};
 
 int main(int argc, char *argv[]) {
 	const auto part = select_part(argc, argv);
-	std::vector<Card> cards;
-	while (has_input(std::cin))
-		cards.push_back(Card::create_from_stream(std::cin));
-	std::cout << (part == 1 ? total_points(cards) : total_cards(cards)) << std::endl;
+	if (part == 1) {
+		std::cout << accumulate_as<Card>(std::cin, std::size_t{0}, [](auto sum, const auto &card) { return sum + card.points(); }) << std::endl;
+	} else {
+		Card_Copies copies;
+		std::cout << accumulate_as<Card>(std::cin, std::size_t{0}, [&copies](auto sum, const auto &card) { return sum + copies.add(card.num_matches()); }) << std::endl;
+	}
 	return 0;
 }
@@ -87,6 +87,44 @@ struct Map : Paragraph_Reader<Map> {
 		return output_ranges;
 	}
 
+	/* Maps ascending values and keeps them ascending. Each converter covers a contiguous block of the values, which
+	 * shifts by a single offset, so the blocks only need reassembling in order of their new values. Where shifted
+	 * blocks overlap, the ascending runs left behind are merged. */
+	void map_sorted_values(std::vector<ulong> &values, std::vector<ulong> &scratch) const {
+		struct Block {
+			std::size_t first, last;
+			ulong offset;
+		};
+
+		std::vector<Block> blocks;
+		std::size_t mapped{0};
+		for (const auto &converter : converters_) {
+			const auto first = static_cast<std::size_t>(std::lower_bound(values.begin() + mapped, values.end(), converter.source_start()) - values.begin());
+			const auto last = static_cast<std::size_t>(std::lower_bound(values.begin() + first, values.end(), converter.source_start() + converter.length()) - values.begin());
+			if (mapped < first)
+				blocks.push_back(Block{mapped, first, 0});
+			if (first < last)
+				blocks.push_back(Block{first, last, converter.destination_start() - converter.source_start()});
+			mapped = last;
+		}
+		if (mapped < values.size())
+			blocks.push_back(Block{mapped, values.size(), 0});
+		std::ranges::sort(blocks, {}, [&values](const Block &block) { return values[block.first] + block.offset; });
+
+		scratch.resize(values.size());
+		auto out = scratch.begin();
+		std::vector<std::size_t> run_bounds{0};
+		for (const auto &block : blocks) {
+			if (out != scratch.begin() && *std::prev(out) > values[block.first] + block.offset)
+				run_bounds.push_back(static_cast<std::size_t>(out - scratch.begin()));
+			out = std::transform(values.begin() + static_cast<long>(block.first), values.begin() + static_cast<long>(block.last), out,
+								 [offset = block.offset](auto value) { return value + offset; });
+		}
+		run_bounds.push_back(values.size());
+		values.swap(scratch);
+		merge_runs(values, std::move(run_bounds));
+	}
+
 	void read_line(const std::string &line) final {
 		if (line_num() != 0)
 			converters_.push_back(Converter::create_from_string(line));
@@ -98,13 +136,30 @@ struct Map : Paragraph_Reader<Map> {
 
 private:
 	std::vector<Converter> converters_;
+
+	/* Merges neighbouring ascending runs pairwise until one remains, where run_bounds is {0, ..., values.size()} */
+	static void merge_runs(std::vector<ulong> &values, std::vector<std::size_t> run_bounds) {
+		while (run_bounds.size() > 2) {
+			std::vector<std::size_t> merged_bounds;
+			for (std::size_t run = 0; run + 1 < run_bounds.size(); run += 2) {
+				merged_bounds.push_back(run_bounds[run]);
+				if (run + 2 < run_bounds.size()) {
+					std::inplace_merge(values.begin() + static_cast<long>(run_bounds[run]), values.begin() + static_cast<long>(run_bounds[run + 1]),
+									   values.begin() + static_cast<long>(run_bounds[run + 2]));
+				}
+			}
+			merged_bounds.push_back(values.size());
+			run_bounds = std::move(merged_bounds);
+		}
+	}
 };
 
-[[nodiscard]] static std::vector<Range> read_seed_values(std::istream &in) {
-	const auto seed_strs = read_tokens(read_line(in), ' ');
-	std::vector<Range> seeds(seed_strs.size() - 1);
+[[nodiscard]] static std::vector<ulong> read_seed_values(std::istream &in) {
+	const auto line = read_line(in);
+	const auto seed_strs = split_view(line, ' ');
+	std::vector<ulong> seeds(seed_strs.size() - 1);
 	std::transform(std::next(seed_strs.begin()), seed_strs.end(), seeds.begin(),
-				   [](const auto &seed_str) { return Range{std::stoul(seed_str), 1}; });
+				   [](auto seed_str) { return parse_integer<ulong>(seed_str); });
 	return seeds;
 }
 
@@ -128,13 +183,24 @@ private:
 	return std::min_element(ranges.begin(), ranges.end())->start;
 }
 
+/* Pushes all seeds through each map as one sorted batch */
+[[nodiscard]] static ulong min_location(std::vector<ulong> seeds, const std::vector<Map> &maps) {
+	std::ranges::sort(seeds);
+	std::vector<ulong> scratch;
+	for (const auto &map : maps)
+		map.map_sorted_values(seeds, scratch);
+	return seeds.front();
+}
+
 int main(int argc, char *argv[]) {
-	const auto seed_ranges = select_part(argc, argv) == 1 ? read_seed_values(std::cin) : read_seed_ranges(std::cin);
+	const auto part = select_part(argc, argv);
+	auto seeds = part == 1 ? read_seed_values(std::cin) : std::vector<ulong>{};
+	const auto seed_ranges = part == 2 ? read_seed_ranges(std::cin) : std::vector<Range>{};
 	read_line(std::cin);
 	std::vector<Map> maps;
 	while (has_input(std::cin))
 		maps.push_back(Map::create_from_stream(std::cin));
 
-	std::cout << min_location(seed_ranges, maps) << std::endl;
+	std::cout << (part == 1 ? min_location(std::move(seeds), maps) : min_location(seed_ranges, maps)) << std::endl;
 	return 0;
 }
\ No newline at end of file
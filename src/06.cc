@@ -1,45 +1,75 @@
 #include "common.h"
+#include <bit>
 
-[[nodiscard]] static std::vector<uint> read_separate_values(std::istream &in) {
-	const auto strs = read_tokens(read_line(in), ' ');
-	std::vector<uint> values;
-	for (auto str_it = std::next(strs.begin()); str_it != strs.end(); ++str_it) {
-		if (!str_it->empty())
-			values.push_back(std::stoi(*str_it));
+[[nodiscard]] static constexpr std::vector<ulong> read_separate_values(std::string_view line) {
+	std::vector<ulong> values;
+	for (auto token : split_view(line.substr(line.find(':') + 1), ' ')) {
+		if (!token.empty())
+			values.push_back(parse_integer<ulong>(token));
 	}
 	return values;
 }
 
-[[nodiscard]] static ulong read_single_value(std::istream &in) {
-	const auto strs = read_tokens(read_line(in), ' ');
-	std::stringstream ss;
-	std::copy(std::next(strs.begin()), strs.end(), std::ostream_iterator<std::string>(ss));
-	return std::stoul(ss.str());
+[[nodiscard]] static constexpr ulong read_single_value(std::string_view line) {
+	ulong value{0};
+	for (auto c : line) {
+		if (is_digit(c))
+			value = value * 10 + (c - '0');
+	}
+	return value;
 }
 
-[[nodiscard]] static std::size_t count_ways_to_win(ulong time, ulong best_distance) {
-	std::size_t count{0};
-	for (ulong t = 1; t < time; ++t) {
-		if (t * (time - t) > best_distance)
-			++count;
-		else if (count != 0)
-			break;
-	}
-	return count;
+/* floor(sqrt(n)) by Newton's method from a power of two above the root, exact for every 128-bit n */
+[[nodiscard]] static constexpr uint128 integer_sqrt(uint128 n) noexcept {
+	if (n < 2)
+		return n;
+	const auto high = static_cast<ulong>(n >> 64);
+	const auto width = high != 0 ? 64 + std::bit_width(high) : std::bit_width(static_cast<ulong>(n));
+	auto root = uint128{1} << ((width + 1) / 2);
+	for (auto next = (root + n / root) / 2; next < root; next = (root + n / root) / 2)
+		root = next;
+	return root;
 }
 
-int main(int argc, char *argv[]) {
-	if (select_part(argc, argv) == 1) {
-		const auto times = read_separate_values(std::cin);
-		const auto distances = read_separate_values(std::cin);
-		uint result{1};
+/* Holding for t wins when t * (time - t) > best_distance, i.e. strictly between the roots of
+ * t^2 - time * t + best_distance. The lower root comes from an exact integer square root of the discriminant, and is
+ * nudged onto the first winning t to absorb rounding. Winning times are symmetric about time / 2. */
+[[nodiscard]] static constexpr std::size_t count_ways_to_win(ulong time, ulong best_distance) {
+	const auto distance = [time](uint128 t) { return t * (time - t); };
+	const auto discriminant_squared = uint128{time} * time;
+	if (discriminant_squared <= uint128{4} * best_distance)
+		return 0;
+
+	auto first = (time - static_cast<ulong>(integer_sqrt(discriminant_squared - uint128{4} * best_distance))) / 2;
+	while (first > 0 && distance(first - 1) > best_distance)
+		--first;
+	while (first <= time / 2 && distance(first) <= best_distance)
+		++first;
+	return first > time / 2 ? 0 : time - 2 * first + 1;
+}
+
+[[nodiscard]] static constexpr std::size_t solve(std::string_view input, uint part) {
+	const auto newline = input.find('\n');
+	const auto time_line = input.substr(0, newline);
+	const auto distance_line = input.substr(newline + 1, input.find('\n', newline + 1) - newline - 1);
+	if (part == 1) {
+		const auto times = read_separate_values(time_line);
+		const auto distances = read_separate_values(distance_line);
+		std::size_t result{1};
 		for (std::size_t i = 0; i < times.size(); ++i)
 			result *= count_ways_to_win(times[i], distances[i]);
-		std::cout << result << std::endl;
-	} else {
-		const auto time = read_single_value(std::cin);
-		const auto distance = read_single_value(std::cin);
-		std::cout << count_ways_to_win(time, distance) << std::endl;
+		return result;
 	}
+	return count_ways_to_win(read_single_value(time_line), read_single_value(distance_line));
+}
+
+int main(int argc, char *argv[]) {
+	const auto part = select_part(argc, argv);
+#ifdef ADVENT_EMBEDDED_INPUT
+	static constexpr std::array answers{solve(embedded_input, 1), solve(embedded_input, 2)};
+	std::cout << answers[part - 1] << std::endl;
+#else
+	std::cout << solve(read_input(std::cin), part) << std::endl;
+#endif
 	return 0;
 }
\ No newline at end of file
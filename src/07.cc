@@ -1,163 +1,229 @@
 #include "common.h"
-#include <numeric>
+#include <array>
+#include <cstdint>
+#include <utility>
 
 enum class Type {
 	HIGH_CARD, ONE_PAIR, TWO_PAIR, THREE_OF_A_KIND, FULL_HOUSE, FOUR_OF_A_KIND, FIVE_OF_A_KIND
 };
 
-struct Normal_Game {
-	[[nodiscard]] static uint card_value(char card) noexcept {
-		switch (card) {
-			case 'A':
-				return 14;
-			case 'K':
-				return 13;
-			case 'Q':
-				return 12;
-			case 'J':
-				return 11;
-			case 'T':
-				return 10;
-			default:
-				return card - '0';
+/* How many times each card value occurs in a hand */
+using Card_Counts = std::array<std::uint8_t, 13>;
+
+[[nodiscard]] static Type classify(std::size_t largest_count, std::size_t second_largest_count) noexcept {
+	switch (largest_count) {
+	case 5:
+		return Type::FIVE_OF_A_KIND;
+	case 4:
+		return Type::FOUR_OF_A_KIND;
+	case 3:
+		return second_largest_count == 2 ? Type::FULL_HOUSE : Type::THREE_OF_A_KIND;
+	case 2:
+		return second_largest_count == 2 ? Type::TWO_PAIR : Type::ONE_PAIR;
+	default:
+		return Type::HIGH_CARD;
+	}
+}
+
+[[nodiscard]] static std::pair<std::size_t, std::size_t> largest_two(const Card_Counts &counts) noexcept {
+	std::size_t largest{0}, second_largest{0};
+	for (std::size_t count : counts) {
+		if (count > largest) {
+			second_largest = largest;
+			largest = count;
+		} else if (count > second_largest) {
+			second_largest = count;
 		}
 	}
+	return {largest, second_largest};
+}
 
-	[[nodiscard]] static Type determine_type(const std::string &hand) noexcept {
-		std::unordered_map<char, std::size_t> card_counts;
-		for (auto card : hand)
-			++card_counts[card];
-
-		bool has_three_of_a_kind{false};
-		std::size_t pair_count{0};
-		for (const auto &[card, count] : card_counts) {
-			if (count == 5)
-				return Type::FIVE_OF_A_KIND;
-			if (count == 4)
-				return Type::FOUR_OF_A_KIND;
-			if (count == 3)
-				has_three_of_a_kind = true;
-			else if (count == 2)
-				++pair_count;
-		}
-		if (has_three_of_a_kind)
-			return pair_count == 1 ? Type::FULL_HOUSE : Type::THREE_OF_A_KIND;
-		if (pair_count == 2)
-			return Type::TWO_PAIR;
-		if (pair_count == 1)
-			return Type::ONE_PAIR;
-		return Type::HIGH_CARD;
+struct Normal_Game {
+	/* Cards are valued by their position in this order */
+	static constexpr std::string_view cards{"23456789TJQKA"};
+
+	[[nodiscard]] static Type determine_type(const Card_Counts &counts) noexcept {
+		const auto [largest, second_largest] = largest_two(counts);
+		return classify(largest, second_largest);
 	}
 };
 
 struct Joker_Game {
-	[[nodiscard]] static uint card_value(char card) noexcept {
-		switch (card) {
-			case 'A':
-				return 14;
-			case 'K':
-				return 13;
-			case 'Q':
-				return 12;
-			case 'J':
-				return 1;
-			case 'T':
-				return 10;
-			default:
-				return card - '0';
-		}
-	}
-
-	[[nodiscard]] static Type determine_type(const std::string &hand) noexcept {
-		std::unordered_map<char, std::size_t> card_counts;
-		std::size_t joker_count{0};
-		for (auto card : hand) {
-			if (card == 'J')
-				++joker_count;
-			else
-				++card_counts[card];
-		}
-		if (joker_count == 5)
-			return Type::FIVE_OF_A_KIND;
-
-		Type high_type{Type::HIGH_CARD};
-		for (const auto &[card, count] : card_counts) {
-			if (count + joker_count == 5)
-				return Type::FIVE_OF_A_KIND;
-			if (count + joker_count == 4)
-				return Type::FOUR_OF_A_KIND;
-			if (count + joker_count == 3)
-				high_type = std::max(high_type, has_other_pair(card, card_counts) ? Type::FULL_HOUSE : Type::THREE_OF_A_KIND);
-			else if (count + joker_count == 2)
-				high_type = std::max(high_type, has_other_pair(card, card_counts) ? Type::TWO_PAIR : Type::ONE_PAIR);
-		}
-		return high_type;
+	static constexpr std::string_view cards{"J23456789TQKA"};
+
+	/* Jokers are best spent joining the largest group */
+	[[nodiscard]] static Type determine_type(Card_Counts counts) noexcept {
+		const std::size_t joker_count{counts[0]};
+		counts[0] = 0;
+		const auto [largest, second_largest] = largest_two(counts);
+		return classify(largest + joker_count, second_largest);
 	}
+};
 
-private:
-	[[nodiscard]] static bool has_other_pair(char card, const std::unordered_map<char, std::size_t> &card_counts) noexcept {
-		return std::ranges::any_of(card_counts, [card](const auto &pair) { return card != pair.first && pair.second == 2; });
+/* Bits of a packed hand key: the type above five 4-bit card values, so that keys order like hands */
+static constexpr std::size_t key_bits{23};
+
+template<typename GameT>
+[[nodiscard]] static std::uint32_t pack_hand(std::string_view hand) {
+	if (hand.size() != 5)
+		throw std::logic_error{"Parse error: a hand has five cards"};
+	Card_Counts counts{};
+	std::uint32_t key{0};
+	for (auto card : hand) {
+		const auto value = GameT::cards.find(card);
+		if (value == std::string_view::npos)
+			throw std::logic_error{"Parse error: unknown card"};
+		++counts[value];
+		key = key << 4 | static_cast<std::uint32_t>(value);
 	}
-
-};
+	return static_cast<std::uint32_t>(GameT::determine_type(counts)) << 20 | key;
+}
 
 struct Hand : Token_Reader<Hand> {
 
 	template<typename GameT>
-	[[nodiscard]] bool worse_than(const Hand &other) const noexcept {
-		const auto type = GameT::determine_type(hand_);
-		const auto other_type = GameT::determine_type(other.hand_);
-		if (type < other_type)
-			return true;
-		if (other_type < type)
-			return false;
-		for (std::size_t i = 0; i < hand_.size(); ++i) {
-			const auto value = GameT::card_value(hand_[i]);
-			const auto other_value = GameT::card_value(other.hand_[i]);
-			if (value < other_value)
-				return true;
-			if (other_value < value)
-				return false;
-		}
-		return false;
+	[[nodiscard]] std::uint32_t key() const noexcept {
+		if constexpr (std::is_same_v<GameT, Joker_Game>)
+			return joker_key_;
+		else
+			return normal_key_;
 	}
 
 	[[nodiscard]] uint bid() const noexcept {
 		return bid_;
 	}
 
+	/* Classify as each hand arrives instead of on every comparison during sorting */
 	void read_token(const std::string &token) final {
 		switch (token_num()) {
 		case 0:
-			hand_ = token;
+			normal_key_ = pack_hand<Normal_Game>(token);
+			joker_key_ = pack_hand<Joker_Game>(token);
 			break;
 		case 1:
-			bid_ = std::stoi(token);
+			bid_ = static_cast<uint>(std::stoul(token));
 			break;
 		}
 	}
 
 private:
-	std::string hand_;
+	std::uint32_t normal_key_, joker_key_;
 	uint bid_;
 };
 
-int main(int argc, char *argv[]) {
-	const auto part = select_part(argc, argv);
+struct Ranked_Hand {
+	std::uint32_t key;
+	uint bid;
+};
+
+/* LSD radix sort over the packed keys, one byte per pass */
+static void radix_sort(std::vector<Ranked_Hand> &hands) {
+	std::vector<Ranked_Hand> sorted(hands.size());
+	for (std::size_t shift = 0; shift < key_bits; shift += 8) {
+		std::array<std::size_t, 256> offsets{};
+		for (const auto &hand : hands)
+			++offsets[hand.key >> shift & 0xff];
+		std::size_t offset{0};
+		for (auto &count : offsets)
+			offset += std::exchange(count, offset);
+		for (const auto &hand : hands)
+			sorted[offsets[hand.key >> shift & 0xff]++] = hand;
+		hands.swap(sorted);
+	}
+}
+
+template<typename GameT>
+[[nodiscard]] static std::size_t total_winnings(std::istream &in) {
+	std::vector<Ranked_Hand> hands;
+	while (has_input(in)) {
+		const auto hand = Hand::create_from_stream(in);
+		hands.push_back(Ranked_Hand{hand.key<GameT>(), hand.bid()});
+	}
+	radix_sort(hands);
+
+	std::size_t winnings{0};
+	for (std::size_t rank = 0; rank < hands.size(); ++rank)
+		winnings += (rank + 1) * hands[rank].bid;
+	return winnings;
+}
 
-	std::vector<Hand> hands;
-	while (has_input(std::cin))
-		hands.push_back(Hand::create_from_stream(std::cin));
+template<typename T>
+struct Fenwick_Tree {
+	explicit Fenwick_Tree(std::size_t size) : tree_(size + 1) { }
 
-	if (part == 1)
-		std::ranges::sort(hands, [](const auto &lhs, const auto &rhs) { return lhs.template worse_than<Normal_Game>(rhs); });
-	else
-		std::ranges::sort(hands, [](const auto &lhs, const auto &rhs) { return lhs.template worse_than<Joker_Game>(rhs); });
+	void add(std::size_t index, T value) noexcept {
+		for (++index; index < tree_.size(); index += index & -index)
+			tree_[index] += value;
+	}
 
-	uint rank{0};
-	std::cout << std::accumulate(hands.begin(), hands.end(), 0ul, [&rank](auto sum, const auto &hand) {
-		return sum + (++rank) * hand.bid();
-	}) << std::endl;
+	/* Sum of the values at indices [0, end) */
+	[[nodiscard]] T prefix_sum(std::size_t end) const noexcept {
+		T sum{};
+		for (; end > 0; end &= end - 1)
+			sum += tree_[end];
+		return sum;
+	}
 
+private:
+	std::vector<T> tree_;
+};
+
+/* Keeps total winnings up to date as hands arrive. A new hand ranks above every hand with a key no greater than its
+ * own, and lifts each hand above it by one rank, which adds their bids once more. Counts and bids are indexed by
+ * hand strength, with the packed card nibbles compressed to base 13 so that the whole key space is dense. */
+struct Leaderboard {
+	/* Returns the total winnings including the new hand */
+	std::size_t insert(std::uint32_t key, uint bid) {
+		const auto index = key_index(key);
+		const auto hands_not_above = counts_.prefix_sum(index + 1);
+		const auto bids_above = total_bids_ - bids_.prefix_sum(index + 1);
+		winnings_ += bids_above + (hands_not_above + 1) * bid;
+
+		counts_.add(index, 1);
+		bids_.add(index, bid);
+		total_bids_ += bid;
+		return winnings_;
+	}
+
+private:
+	static constexpr std::size_t num_keys{7 * 13 * 13 * 13 * 13 * 13};
+
+	Fenwick_Tree<std::size_t> counts_{num_keys}, bids_{num_keys};
+	std::size_t total_bids_{0};
+	std::size_t winnings_{0};
+
+	[[nodiscard]] static std::size_t key_index(std::uint32_t key) noexcept {
+		std::size_t index{key >> 20};
+		for (std::size_t shift = 20; shift > 0; shift -= 4)
+			index = index * 13 + (key >> (shift - 4) & 0xf);
+		return index;
+	}
+};
+
+/* Prints the total winnings after every hand */
+template<typename GameT>
+static void print_running_winnings(std::istream &in) {
+	Leaderboard leaderboard;
+	while (has_input(in)) {
+		const auto hand = Hand::create_from_stream(in);
+		std::cout << leaderboard.insert(hand.key<GameT>(), hand.bid()) << '\n';
+	}
+	std::cout << std::flush;
+}
+
+int main(int argc, char *argv[]) {
+	const auto part = select_part(argc, argv);
+	const auto arguments = extra_arguments(argc, argv);
+	if (arguments.empty()) {
+		std::cout << (part == 1 ? total_winnings<Normal_Game>(std::cin) : total_winnings<Joker_Game>(std::cin)) << std::endl;
+	} else if (arguments[0] == "online") {
+		if (part == 1)
+			print_running_winnings<Normal_Game>(std::cin);
+		else
+			print_running_winnings<Joker_Game>(std::cin);
+	} else {
+		std::cerr << argv[0] << ": invalid argument '" << arguments[0] << "'" << std::endl;
+		return 1;
+	}
 	return 0;
 }
\ No newline at end of file
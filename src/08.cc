@@ -1,89 +1,370 @@
 #include "common.h"
-#include <numeric>
+#include <array>
+#include <cstdint>
+#include <limits>
+#include <optional>
+#include <span>
+#include <thread>
+#include <utility>
 
-struct Node : Token_Reader<Node> {
+/* Gives node labels dense IDs in order of first appearance. Three-letter labels are looked up in a table indexed by
+ * their base-26 value, and any other label falls back to hashing. */
+struct Label_Interner {
+	[[nodiscard]] std::uint32_t intern(std::string_view label) {
+		if (const auto packed = pack(label)) {
+			auto &id = packed_ids_[*packed];
+			if (id == no_id)
+				id = add(label);
+			return id;
+		}
+		if (const auto it = other_ids_.find(std::string{label}); it != other_ids_.end())
+			return it->second;
+		return other_ids_[std::string{label}] = add(label);
+	}
 
-	[[nodiscard]] const std::string &label() const noexcept {
-		return label_;
+	[[nodiscard]] std::optional<std::uint32_t> find(std::string_view label) const {
+		if (const auto packed = pack(label))
+			return packed_ids_[*packed] == no_id ? std::nullopt : std::optional{packed_ids_[*packed]};
+		const auto it = other_ids_.find(std::string{label});
+		return it == other_ids_.end() ? std::nullopt : std::optional{it->second};
 	}
 
-	[[nodiscard]] const Node &left() const noexcept {
-		return *left_;
+	[[nodiscard]] std::size_t size() const noexcept {
+		return last_letters_.size();
 	}
 
-	[[nodiscard]] const Node &right() const noexcept {
-		return *right_;
+	[[nodiscard]] char last_letter(std::uint32_t id) const noexcept {
+		return last_letters_[id];
 	}
 
-	void assign_children(const std::unordered_map<std::string, Node> &nodes) {
-		left_ = &nodes.at(left_label_);
-		right_ = &nodes.at(right_label_);
+private:
+	static constexpr std::uint32_t no_id{std::numeric_limits<std::uint32_t>::max()};
+
+	std::vector<std::uint32_t> packed_ids_ = std::vector<std::uint32_t>(26 * 26 * 26, no_id);
+	std::unordered_map<std::string, std::uint32_t> other_ids_;
+	std::vector<char> last_letters_;
+
+	[[nodiscard]] std::uint32_t add(std::string_view label) {
+		last_letters_.push_back(label.back());
+		return static_cast<std::uint32_t>(last_letters_.size() - 1);
 	}
 
-	void read_token(const std::string &token) final {
-		switch (token_num()) {
-		case 0:
-			label_ = token;
-			break;
-		case 2:
-			left_label_ = token.substr(1, 3);
-			break;
-		case 3:
-			right_label_ = token.substr(0, 3);
-			break;
+	[[nodiscard]] static std::optional<std::size_t> pack(std::string_view label) noexcept {
+		if (label.size() != 3)
+			return std::nullopt;
+		std::size_t packed{0};
+		for (auto c : label) {
+			if (c < 'A' || 'Z' < c)
+				return std::nullopt;
+			packed = packed * 26 + static_cast<std::size_t>(c - 'A');
 		}
+		return packed;
+	}
+};
+
+/* Nodes are dense IDs with their left and right successors in two flat arrays, and the instructions are a bit vector
+ * (set for right), so a step is an indexed load selected by one bit */
+struct Network {
+	[[nodiscard]] static Network create_from_stream(std::istream &in) {
+		Network network;
+		network.read_instructions(read_line(in));
+		read_line(in);
+		for (std::string line; std::getline(in, line) && !line.empty(); )
+			network.read_node(line);
+		if (std::ranges::find(network.defined_, false) != network.defined_.end())
+			throw std::logic_error{"Parse error: a node is referenced but never defined"};
+		return network;
+	}
+
+	[[nodiscard]] std::uint32_t node(std::string_view label) const {
+		const auto id = labels_.find(label);
+		if (!id)
+			throw std::logic_error{"No node labelled " + std::string{label}};
+		return *id;
+	}
+
+	[[nodiscard]] std::vector<std::uint32_t> nodes_ending_with(char letter) const {
+		std::vector<std::uint32_t> result;
+		for (std::uint32_t id = 0; id < labels_.size(); ++id) {
+			if (labels_.last_letter(id) == letter)
+				result.push_back(id);
+		}
+		return result;
+	}
+
+	[[nodiscard]] std::vector<bool> node_set(const std::vector<std::uint32_t> &nodes) const {
+		std::vector<bool> set(labels_.size());
+		for (auto id : nodes)
+			set[id] = true;
+		return set;
+	}
+
+	[[nodiscard]] std::size_t num_nodes() const noexcept {
+		return labels_.size();
+	}
+
+	[[nodiscard]] std::size_t num_instructions() const noexcept {
+		return num_instructions_;
+	}
+
+	[[nodiscard]] std::uint32_t step(std::uint32_t node, std::size_t instruction) const noexcept {
+		return successors_[instructions_[instruction / 64] >> (instruction % 64) & 1][node];
 	}
+
 private:
-	std::string label_, left_label_, right_label_;
-	const Node *left_, *right_;
+	Label_Interner labels_;
+	std::array<std::vector<std::uint32_t>, 2> successors_;
+	std::vector<bool> defined_;
+	std::vector<std::uint64_t> instructions_;
+	std::size_t num_instructions_{0};
+
+	void read_instructions(std::string_view line) {
+		if (line.empty())
+			throw std::logic_error{"Parse error: expected at least one instruction"};
+		num_instructions_ = line.size();
+		instructions_.assign((line.size() + 63) / 64, 0);
+		for (std::size_t i = 0; i < line.size(); ++i) {
+			if (line[i] != 'L' && line[i] != 'R')
+				throw std::logic_error{"Parse error: instructions are 'L' or 'R'"};
+			instructions_[i / 64] |= std::uint64_t{line[i] == 'R'} << (i % 64);
+		}
+	}
+
+	/* Reads "AAA = (BBB, CCC)" */
+	void read_node(std::string_view line) {
+		const auto open = line.find('('), comma = line.find(','), close = line.find(')');
+		if (open == std::string_view::npos || comma == std::string_view::npos || close == std::string_view::npos)
+			throw std::logic_error{"Parse error: expected a node definition"};
+		const auto label = line.substr(0, line.find(' '));
+		const auto left = line.substr(open + 1, comma - open - 1);
+		const auto right = line.substr(line.find_first_not_of(' ', comma + 1), close - line.find_first_not_of(' ', comma + 1));
+
+		const auto id = labels_.intern(label);
+		const auto left_id = labels_.intern(left), right_id = labels_.intern(right);
+		for (auto &successors : successors_)
+			successors.resize(labels_.size());
+		defined_.resize(labels_.size());
+		if (defined_[id])
+			throw std::logic_error{"Parse error: a node is defined more than once"};
+		successors_[0][id] = left_id;
+		successors_[1][id] = right_id;
+		defined_[id] = true;
+	}
 };
 
-[[nodiscard]] std::size_t steps_required(Circular_Queue<char, std::string> instructions,
-										 const std::unordered_map<std::string, Node> &nodes) {
-	std::size_t steps{0};
-	for (auto *current_ptr = &nodes.at("AAA"); current_ptr->label() != "ZZZ"; ++steps)
-		current_ptr = &(instructions.take() == 'L' ? current_ptr->left() : current_ptr->right());
-	return steps;
-}
+/* For a walk that starts a pass of the instructions at each node: the node it finishes the pass on, and the offsets
+ * within the pass at which it stands on an end node. Jumps of 2^k passes are kept for binary lifting. */
+struct Pass_Table {
+	Pass_Table(const Network &network, const std::vector<bool> &ends) : pass_length_{network.num_instructions()} {
+		const auto num_nodes = network.num_nodes();
+		auto &pass_ends = jumps_.emplace_back(num_nodes);
+		end_offset_starts_.reserve(num_nodes + 1);
+		for (std::uint32_t start = 0; start < num_nodes; ++start) {
+			end_offset_starts_.push_back(end_offsets_.size());
+			auto node = start;
+			for (std::size_t instruction = 0; instruction < pass_length_; ++instruction) {
+				if (ends[node])
+					end_offsets_.push_back(instruction);
+				node = network.step(node, instruction);
+			}
+			pass_ends[start] = node;
+		}
+		end_offset_starts_.push_back(end_offsets_.size());
+
+		/* A walk repeats within num_nodes passes, so no jump needs to be longer */
+		for (std::size_t level = 1; (std::size_t{1} << level) < num_nodes; ++level) {
+			const auto &half = jumps_.back();
+			std::vector<std::uint32_t> jump(num_nodes);
+			for (std::size_t node = 0; node < num_nodes; ++node)
+				jump[node] = half[half[node]];
+			jumps_.push_back(std::move(jump));
+		}
+	}
 
-[[nodiscard]] std::vector<const Node *> starting_nodes(const std::unordered_map<std::string, Node> &nodes) {
-	std::vector<const Node *> result;
-	for (const auto &[label, node] : nodes) {
-		if (label.back() == 'A')
-			result.push_back(&node);
+	[[nodiscard]] std::size_t num_nodes() const noexcept {
+		return jumps_[0].size();
+	}
+
+	[[nodiscard]] std::size_t pass_length() const noexcept {
+		return pass_length_;
+	}
+
+	[[nodiscard]] std::uint32_t after_pass(std::uint32_t node) const noexcept {
+		return jumps_[0][node];
+	}
+
+	/* Requires passes < 2^levels, which covers any walk's tail and cycle */
+	[[nodiscard]] std::uint32_t after_passes(std::uint32_t node, std::size_t passes) const noexcept {
+		for (std::size_t level = 0; passes != 0; ++level, passes >>= 1) {
+			if (passes & 1)
+				node = jumps_[level][node];
+		}
+		return node;
 	}
-	return result;
-}
 
-[[nodiscard]] std::size_t steps_until_end(Circular_Queue<char, std::string> instructions, const Node &node) {
-	std::size_t steps{0};
-	for (auto *current_ptr = &node; current_ptr->label().back() != 'Z'; ++steps)
-		current_ptr = &(instructions.take() == 'L' ? current_ptr->left() : current_ptr->right());
-	return steps;
+	[[nodiscard]] std::span<const std::size_t> end_offsets(std::uint32_t node) const noexcept {
+		return std::span{end_offsets_}.subspan(end_offset_starts_[node], end_offset_starts_[node + 1] - end_offset_starts_[node]);
+	}
+
+private:
+	std::size_t pass_length_;
+	std::vector<std::vector<std::uint32_t>> jumps_;
+	std::vector<std::size_t> end_offsets_, end_offset_starts_;
+};
+
+/* A ghost's walk, pass by pass: the passes before it starts repeating, the length of the repeating cycle, and every
+ * step at which it stands on an end node, split into those before the cycle and those in its first repetition */
+struct Ghost_Walk {
+	/* first_pass is scratch space shared by the walks on one thread, holding the pass on which each node was first
+	 * reached; only the entries this walk set are reset afterwards */
+	Ghost_Walk(const Pass_Table &table, std::uint32_t start, std::vector<std::size_t> &first_pass) : start_{start} {
+		static constexpr std::size_t unvisited{std::numeric_limits<std::size_t>::max()};
+		first_pass.resize(table.num_nodes(), unvisited);
+		std::vector<std::pair<std::size_t, std::uint32_t>> visits;
+		auto node = start;
+		for (std::size_t pass = 0; first_pass[node] == unvisited; ++pass, node = table.after_pass(node)) {
+			first_pass[node] = pass;
+			visits.emplace_back(pass, node);
+		}
+		tail_passes_ = first_pass[node];
+		cycle_passes_ = visits.size() - tail_passes_;
+		for (const auto &visit : visits)
+			first_pass[visit.second] = unvisited;
+
+		for (const auto &[pass, visited] : visits) {
+			for (auto offset : table.end_offsets(visited))
+				(pass < tail_passes_ ? tail_hits_ : cycle_hits_).push_back(pass * table.pass_length() + offset);
+		}
+	}
+
+	[[nodiscard]] std::size_t tail_steps(const Pass_Table &table) const noexcept {
+		return tail_passes_ * table.pass_length();
+	}
+
+	[[nodiscard]] std::size_t cycle_steps(const Pass_Table &table) const noexcept {
+		return cycle_passes_ * table.pass_length();
+	}
+
+	[[nodiscard]] const std::vector<std::size_t> &tail_hits() const noexcept {
+		return tail_hits_;
+	}
+
+	[[nodiscard]] const std::vector<std::size_t> &cycle_hits() const noexcept {
+		return cycle_hits_;
+	}
+
+	[[nodiscard]] bool at_end(const Pass_Table &table, uint128 step) const {
+		auto passes = step / table.pass_length();
+		if (passes >= tail_passes_)
+			passes = tail_passes_ + (passes - tail_passes_) % cycle_passes_;
+		const auto offsets = table.end_offsets(table.after_passes(start_, static_cast<std::size_t>(passes)));
+		return std::ranges::binary_search(offsets, static_cast<std::size_t>(step % table.pass_length()));
+	}
+
+private:
+	std::uint32_t start_;
+	std::size_t tail_passes_, cycle_passes_;
+	std::vector<std::size_t> tail_hits_, cycle_hits_;
+};
+
+/* The steps t with t = residue (mod modulus) */
+struct Congruence {
+	uint128 residue, modulus;
+};
+
+/* Inverse of value modulo modulus, for coprime arguments below 2^64 */
+[[nodiscard]] static uint128 modular_inverse(uint128 value, uint128 modulus) noexcept {
+	__int128 old_r{static_cast<__int128>(value)}, r{static_cast<__int128>(modulus)}, old_s{1}, s{0};
+	while (r != 0) {
+		const auto quotient = old_r / r;
+		old_r = std::exchange(r, old_r - quotient * r);
+		old_s = std::exchange(s, old_s - quotient * s);
+	}
+	const auto signed_modulus = static_cast<__int128>(modulus);
+	return static_cast<uint128>((old_s % signed_modulus + signed_modulus) % signed_modulus);
 }
 
-[[nodiscard]] std::size_t simultaneous_steps_required(Circular_Queue<char, std::string> instructions,
-													  const std::unordered_map<std::string, Node> &nodes) {
-	auto current_nodes = starting_nodes(nodes);
-	return std::accumulate(current_nodes.begin(), current_nodes.end(), 1ul, [&instructions](auto result, auto node_ptr) {
-		return std::lcm(result, steps_until_end(instructions, *node_ptr));
-	});
+/* Generalized CRT: the congruence holding exactly where both do, if they are compatible. The moduli need not be
+ * coprime, but the second must fit in 64 bits so that the intermediate product cannot overflow. */
+[[nodiscard]] static std::optional<Congruence> combine(const Congruence &lhs, uint128 residue, std::uint64_t modulus) {
+	uint128 divisor{lhs.modulus}, remainder{modulus};
+	while (remainder != 0)
+		divisor = std::exchange(remainder, divisor % remainder);
+	const auto difference = (residue % modulus + modulus - lhs.residue % modulus) % modulus;
+	if (difference % divisor != 0)
+		return std::nullopt;
+
+	const auto reduced_modulus = modulus / divisor;
+	const auto multiple = difference / divisor * modular_inverse(lhs.modulus / divisor % reduced_modulus, reduced_modulus) % reduced_modulus;
+	if (lhs.modulus > std::numeric_limits<uint128>::max() / reduced_modulus)
+		throw std::overflow_error{"Combined cycle length exceeds 128 bits"};
+	return Congruence{lhs.residue + lhs.modulus * multiple, lhs.modulus * reduced_modulus};
 }
 
-int main(int argc, char *argv[]) {
-	const auto part = select_part(argc, argv);
-	auto instructions = Circular_Queue<char, std::string>(read_line(std::cin));
-	read_line(std::cin);
+/* The first step at which every ghost stands on an end node at once. Until every ghost is cycling, any such step must
+ * be a tail hit of the ghost with the longest tail; after that, each ghost constrains the step to its cycle hits
+ * modulo its cycle length. */
+[[nodiscard]] static uint128 earliest_common_end(const Network &network, const std::vector<std::uint32_t> &starts, const std::vector<bool> &ends) {
+	const Pass_Table table{network, ends};
+	std::vector<std::optional<Ghost_Walk>> walks(starts.size());
+	const auto num_threads = std::min<std::size_t>(starts.size(), std::max(1u, std::thread::hardware_concurrency()));
+	{
+		std::vector<std::jthread> threads;
+		for (std::size_t thread = 0; thread < num_threads; ++thread) {
+			threads.emplace_back([&table, &walks, &starts, thread, num_threads] {
+				std::vector<std::size_t> first_pass;
+				for (auto ghost = thread; ghost < starts.size(); ghost += num_threads)
+					walks[ghost].emplace(table, starts[ghost], first_pass);
+			});
+		}
+	}
+
+	const auto all_at_end = [&table, &walks](uint128 step) {
+		return std::ranges::all_of(walks, [&table, step](const auto &walk) { return walk->at_end(table, step); });
+	};
+	std::optional<uint128> earliest;
+	for (const auto &walk : walks) {
+		for (auto hit : walk->tail_hits()) {
+			if ((!earliest || hit < *earliest) && all_at_end(hit))
+				earliest = hit;
+		}
+	}
+	if (earliest)
+		return *earliest;
+
+	std::vector<Congruence> solutions{Congruence{0, 1}};
+	std::size_t all_cycling{0};
+	for (const auto &walk : walks) {
+		all_cycling = std::max(all_cycling, walk->tail_steps(table));
+		std::vector<Congruence> combined;
+		for (const auto &solution : solutions) {
+			for (auto hit : walk->cycle_hits()) {
+				if (const auto congruence = combine(solution, hit, walk->cycle_steps(table)))
+					combined.push_back(*congruence);
+			}
+		}
+		std::ranges::sort(combined, {}, &Congruence::residue);
+		const auto duplicates = std::ranges::unique(combined, {}, &Congruence::residue);
+		combined.erase(duplicates.begin(), duplicates.end());
+		solutions = std::move(combined);
+	}
+	if (solutions.empty())
+		throw std::logic_error{"The ghosts never stand on end nodes together"};
 
-	std::unordered_map<std::string, Node> nodes;
-	while (has_input(std::cin)) {
-		auto node = Node::create_from_stream(std::cin);
-		const auto label = node.label();
-		nodes.emplace(label, std::move(node));
+	for (const auto &[residue, modulus] : solutions) {
+		const auto step = residue >= all_cycling ? residue : residue + (all_cycling - residue + modulus - 1) / modulus * modulus;
+		if (!earliest || step < *earliest)
+			earliest = step;
 	}
-	for (auto &[label, node] : nodes)
-		node.assign_children(nodes);
+	return *earliest;
+}
 
-	std::cout << (part == 1 ? steps_required(instructions, nodes) : simultaneous_steps_required(instructions, nodes)) << std::endl;
+int main(int argc, char *argv[]) {
+	const auto part = select_part(argc, argv);
+	const auto network = Network::create_from_stream(std::cin);
+	const auto steps = part == 1
+		? earliest_common_end(network, {network.node("AAA")}, network.node_set({network.node("ZZZ")}))
+		: earliest_common_end(network, network.nodes_ending_with('A'), network.node_set(network.nodes_ending_with('Z')));
+	std::cout << to_string(steps) << std::endl;
 	return 0;
 }
\ No newline at end of file
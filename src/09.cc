@@ -1,53 +1,82 @@
 #include "common.h"
-#include <numeric>
+#include <cstdint>
 
-struct History : Token_Reader<History> {
+/* Weights that extrapolate a sequence of length n straight from its values, as the difference pyramid would:
+ *   next     = sum over i of (-1)^(n-1-i) C(n, i)   y_i
+ *   previous = sum over i of (-1)^i       C(n, i+1) y_i
+ * Arithmetic wraps modulo 2^64, so a prediction is exact whenever it fits in 64 bits, however large the binomials. */
+struct Extrapolation_Weights {
+	std::vector<std::uint64_t> next, previous;
 
-	History() {
-		levels_.emplace_back();
-	}
+	[[nodiscard]] static constexpr Extrapolation_Weights for_length(std::size_t length) {
+		std::vector<std::uint64_t> binomials{1};
+		for (std::size_t row = 1; row <= length; ++row) {
+			binomials.push_back(1);
+			for (auto k = row - 1; k > 0; --k)
+				binomials[k] += binomials[k - 1];
+		}
 
-	[[nodiscard]] int future_prediction() const {
-		return std::accumulate(levels_.begin(), levels_.end(), 0,
-							   [](auto result, const auto &level) { return result + level.back(); });
+		Extrapolation_Weights weights;
+		for (std::size_t i = 0; i < length; ++i) {
+			weights.next.push_back((length - 1 - i) % 2 == 0 ? binomials[i] : -binomials[i]);
+			weights.previous.push_back(i % 2 == 0 ? binomials[i + 1] : -binomials[i + 1]);
+		}
+		return weights;
 	}
+};
 
-	[[nodiscard]] int past_prediction() const {
-		return std::accumulate(std::next(levels_.rbegin()), levels_.rend(), 0,
-							   [](auto result, const auto &level) { return level.front() - result; });
+/* Weights for each sequence length seen so far, computed on first use */
+struct Weight_Cache {
+	[[nodiscard]] constexpr const Extrapolation_Weights &for_length(std::size_t length) {
+		if (length >= weights_.size())
+			weights_.resize(length + 1);
+		if (weights_[length].next.size() != length)
+			weights_[length] = Extrapolation_Weights::for_length(length);
+		return weights_[length];
 	}
 
-	void read_token(const std::string &token) final {
-		levels_.back().push_back(std::stoi(token));
-	}
+private:
+	std::vector<Extrapolation_Weights> weights_;
+};
 
-	void read_end() final {
-		while (std::ranges::any_of(levels_.back(), [](auto val) { return val != 0; })) {
-			std::vector<int> level;
-			level.reserve(levels_.back().size() - 1);
-			for (std::size_t i = 0; i < levels_.back().size() - 1; ++i)
-				level.push_back(levels_.back()[i + 1] - levels_.back()[i]);
-			levels_.push_back(std::move(level));
-		}
+template<typename FuncT>
+constexpr void foreach_value(std::string_view line, const FuncT &func) {
+	for (auto start = line.find_first_not_of(' '); start != std::string_view::npos; ) {
+		const auto end = std::min(line.find(' ', start), line.size());
+		func(parse_integer<long>(line.substr(start, end - start)));
+		start = line.find_first_not_of(' ', end);
 	}
+}
 
-private:
-	std::vector<std::vector<int>> levels_;
-};
+/* A single dot product with the weights for the history's length, read straight from the line */
+[[nodiscard]] static constexpr std::uint64_t predict(std::string_view line, Weight_Cache &cache, uint part) {
+	std::size_t length{0};
+	foreach_value(line, [&length](auto) { ++length; });
+	const auto &weights = cache.for_length(length);
+	const auto &coefficients = part == 1 ? weights.next : weights.previous;
+
+	std::uint64_t prediction{0};
+	std::size_t i{0};
+	foreach_value(line, [&prediction, &coefficients, &i](auto value) { prediction += coefficients[i++] * static_cast<std::uint64_t>(value); });
+	return prediction;
+}
+
+[[nodiscard]] static constexpr long sum_predictions(std::string_view in, uint part) {
+	Weight_Cache cache;
+	std::uint64_t sum{0};
+	foreach_line(in, [&sum, &cache, part](auto line) { sum += predict(line, cache, part); });
+	return static_cast<long>(sum);
+}
 
 int main(int argc, char *argv[]) {
-	auto histories = read_as<History>(std::cin);
-	switch (select_part(argc, argv)) {
-	case 1:
-		std::cout << std::accumulate(histories.begin(), histories.end(), 0, [](auto sum, const auto &history) {
-			return sum + history.future_prediction();
-		}) << std::endl;
-		break;
-	case 2:
-		std::cout << std::accumulate(histories.begin(), histories.end(), 0, [](auto sum, const auto &history) {
-			return sum + history.past_prediction();
-		}) << std::endl;
-		break;
-	}
+	const auto part = select_part(argc, argv);
+#ifdef ADVENT_EMBEDDED_INPUT
+	static constexpr std::array answers{sum_predictions(embedded_input, 1), sum_predictions(embedded_input, 2)};
+	std::cout << answers[part - 1] << std::endl;
+#else
+	Weight_Cache cache;
+	const auto sum = accumulate_lines(std::cin, std::uint64_t{0}, [&cache, part](auto sum, const auto &line) { return sum + predict(line, cache, part); });
+	std::cout << static_cast<long>(sum) << std::endl;
+#endif
 	return 0;
 }
\ No newline at end of file
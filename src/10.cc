@@ -1,147 +1,147 @@
 #include "common.h"
+#include <bit>
 #include <cstdint>
-#include <deque>
-#include <limits>
-#include <numeric>
-
-struct Tile {
-	static constexpr std::size_t INF{std::numeric_limits<std::size_t>::max()};
-
-	explicit Tile(char symbol) noexcept
-		: symbol_{symbol} { }
-
-	[[nodiscard]] bool is_start() const noexcept {
-		return symbol_ == 'S';
-	}
-
-	[[nodiscard]] std::size_t distance_from_start() const noexcept {
-		return distance_from_start_;
-	}
-
-	[[nodiscard]] bool on_loop() const noexcept {
-		return distance_from_start_ != INF;
-	}
-
-	void link_neighbors(std::vector<std::vector<Tile>> &grid, std::size_t row, std::size_t column) {
-		if (symbol_one_of<'|', '7', 'F', 'S'>(symbol_) && row < grid.size() - 1 && symbol_one_of<'|', 'L', 'J', 'S'>(grid[row + 1][column].symbol_))
-			link_neighbor(grid[row + 1][column]);
-		if (symbol_one_of<'-', 'L', 'F', 'S'>(symbol_) && column < grid[0].size() - 1 && symbol_one_of<'-', 'J', '7', 'S'>(grid[row][column + 1].symbol_))
-			link_neighbor(grid[row][column + 1]);
+#include <cstdlib>
+#include <optional>
+
+/* One byte per cell: a bit for each Grid_Direction the pipe connects to, plus whether the cell is on the loop */
+struct Pipe_Maze {
+	[[nodiscard]] static Pipe_Maze create_from_stream(std::istream &in) {
+		Pipe_Maze maze;
+		for (std::string line; std::getline(in, line) && !line.empty(); ++maze.num_rows_) {
+			if (maze.num_rows_ == 0)
+				maze.num_columns_ = line.size();
+			else if (line.size() != maze.num_columns_)
+				throw std::logic_error{"Parse error: maze rows differ in width"};
+			for (std::size_t column = 0; column < line.size(); ++column) {
+				if (line[column] == 'S')
+					maze.start_ = Grid_Position{maze.num_rows_, column};
+				maze.cells_.push_back(connections(line[column]));
+			}
+		}
+		if (!maze.start_)
+			throw std::logic_error{"Unable to find starting position"};
+		maze.connect_start();
+		return maze;
 	}
 
-	void calculate_loop_distances() {
-		if (symbol_ != 'S')
-			throw std::logic_error{"Must invoke from start tile"};
+	struct Loop {
+		std::size_t length;
+		/* Twice the area enclosed by the path through the tile centres, signed by orientation */
+		long doubled_area;
 
-		std::deque<const Tile *> to_visit;
-		for (auto neighbor_ptr : neighbors_) {
-			neighbor_ptr->distance_from_start_ = 1;
-			to_visit.push_back(neighbor_ptr);
+		/* Pick's theorem: the area is the interior tiles plus half the boundary tiles, less one */
+		[[nodiscard]] std::size_t enclosed_tiles() const noexcept {
+			return static_cast<std::size_t>(std::abs(doubled_area)) / 2 - length / 2 + 1;
 		}
+	};
+
+	/* Walks the loop once from the start, marking its cells and summing the shoelace formula along the way */
+	Loop trace_loop() {
+		auto position = *start_;
+		Grid_Direction direction{std::countr_zero(cell(position))};
+		Loop loop{0, 0};
+		do {
+			cell(position) |= on_loop_bit;
+			if (!position.can_move(direction, num_rows_, num_columns_))
+				throw std::logic_error{"The loop leaves the maze"};
+			const auto previous = position;
+			position = position.move(direction);
+			++loop.length;
+			loop.doubled_area += static_cast<long>(previous.c * position.r) - static_cast<long>(position.c * previous.r);
+
+			const auto pipe = cell(position) & connection_bits;
+			if (!(pipe & bit(direction.reverse())))
+				throw std::logic_error{"The loop is broken"};
+			direction = std::countr_zero(static_cast<std::uint8_t>(pipe & ~bit(direction.reverse())));
+		} while (position != *start_);
+		return loop;
+	}
 
-		while (!to_visit.empty()) {
-			auto current = to_visit.front();
-			to_visit.pop_front();
-			for (auto next_ptr : current->neighbors_) {
-				if (current->distance_from_start_ + 1 < next_ptr->distance_from_start_) {
-					next_ptr->distance_from_start_ = current->distance_from_start_ + 1;
-					to_visit.push_back(next_ptr);
-				}
+	/* Cross-check for Loop::enclosed_tiles: scanning a row, a tile is inside when an odd number of loop tiles
+	 * connecting upwards lie to its left. Requires the loop to be traced. */
+	[[nodiscard]] std::size_t count_enclosed_by_scanline() const noexcept {
+		std::size_t enclosed{0};
+		for (std::size_t row = 0; row < num_rows_; ++row) {
+			bool inside{false};
+			for (std::size_t column = 0; column < num_columns_; ++column) {
+				const auto tile = cell(Grid_Position{row, column});
+				if (tile & on_loop_bit)
+					inside ^= static_cast<bool>(tile & bit(Grid_Direction::UP));
+				else
+					enclosed += inside;
 			}
 		}
-	}
-
-	[[nodiscard]] bool connects_to(const Tile &other) const noexcept {
-		return std::ranges::find(neighbors_, &other) != neighbors_.end();
+		return enclosed;
 	}
 
 private:
-	template<char ...symbols>
-	[[nodiscard]] static bool symbol_one_of(char symbol) {
-		return ((symbol == symbols) || ...);
-	}
+	static constexpr std::uint8_t connection_bits{0xf};
+	static constexpr std::uint8_t on_loop_bit{0x10};
 
-	void link_neighbor(Tile &other) noexcept {
-		neighbors_.emplace_back(&other);
-		other.neighbors_.emplace_back(this);
-	}
+	std::size_t num_rows_{0}, num_columns_{0};
+	std::optional<Grid_Position> start_;
+	std::vector<std::uint8_t> cells_;
 
-	char symbol_;
-	std::vector<Tile *> neighbors_;
-	std::size_t distance_from_start_{INF};
-};
-
-[[nodiscard]] static Tile &find_start(std::vector<std::vector<Tile>> &grid) {
-	for (auto &row : grid) {
-		auto it = std::ranges::find_if(row, [](const auto &tile) { return tile.is_start(); });
-		if (it != row.end())
-			return *it;
+	[[nodiscard]] static constexpr std::uint8_t bit(int direction) noexcept {
+		return static_cast<std::uint8_t>(1 << direction);
 	}
-	throw std::logic_error{"Unable to find starting position"};
-}
 
-[[nodiscard]] static std::size_t find_max_distance(std::vector<std::vector<Tile>> &grid) {
-	std::size_t result{0};
-	for (const auto &row : grid) {
-		for (const auto &tile : row) {
-			if (tile.distance_from_start() != Tile::INF)
-				result = std::max(result, tile.distance_from_start());
+	[[nodiscard]] static std::uint8_t connections(char symbol) {
+		switch (symbol) {
+		case '|':
+			return bit(Grid_Direction::UP) | bit(Grid_Direction::DOWN);
+		case '-':
+			return bit(Grid_Direction::LEFT) | bit(Grid_Direction::RIGHT);
+		case 'L':
+			return bit(Grid_Direction::UP) | bit(Grid_Direction::RIGHT);
+		case 'J':
+			return bit(Grid_Direction::UP) | bit(Grid_Direction::LEFT);
+		case '7':
+			return bit(Grid_Direction::DOWN) | bit(Grid_Direction::LEFT);
+		case 'F':
+			return bit(Grid_Direction::DOWN) | bit(Grid_Direction::RIGHT);
+		case '.':
+		case 'S':
+			return 0;
+		default:
+			throw std::logic_error{"Parse error: unknown tile"};
 		}
 	}
-	return result;
-}
 
-[[nodiscard]] static std::size_t count_loop_size(const std::vector<std::vector<Tile>> &grid) {
-	return std::accumulate(grid.begin(), grid.end(), std::size_t{0}, [](auto sum, const auto &row) {
-		return sum + std::accumulate(row.begin(), row.end(), std::size_t{0},
-									 [](auto sum, const auto &tile) { return sum + tile.on_loop(); });
-	});
-}
+	[[nodiscard]] std::uint8_t &cell(const Grid_Position &position) noexcept {
+		return cells_[position.r * num_columns_ + position.c];
+	}
 
-[[nodiscard]] static std::size_t count_enclosed(const std::vector<std::vector<Tile>> &grid) {
-	std::vector<std::vector<std::uint8_t>> visited(grid.size() * 2 + 1, std::vector<std::uint8_t>(grid[0].size() * 2 + 1, false));
-	std::deque<Grid_Position> to_visit{Grid_Position{0, 0}};
-	std::size_t non_enclosed_count{0};
-	while (!to_visit.empty()) {
-		const auto position = to_visit.front();
-		to_visit.pop_front();
-		if (visited[position.r][position.c])
-			continue;
-		visited[position.r][position.c] = true;
+	[[nodiscard]] std::uint8_t cell(const Grid_Position &position) const noexcept {
+		return cells_[position.r * num_columns_ + position.c];
+	}
 
-		if (position.r % 2 == 1 && position.c % 2 == 1) {
-			if (grid[(position.r - 1) / 2][(position.c - 1) / 2].on_loop())
-				continue;
-			++non_enclosed_count;
-		} else if (position.r % 2 == 0 && position.c % 2 == 1) {
-			if (0 < position.r && position.r < visited.size() - 1 && grid[(position.r - 1) / 2][(position.c - 1) / 2].connects_to(grid[position.r / 2][(position.c - 1) / 2]))
-				continue;
-		} else if (position.r % 2 == 1 && position.c % 2 == 0) {
-			if (0 < position.c && position.c < visited[0].size() - 1 && grid[(position.r - 1) / 2][(position.c - 1) / 2].connects_to(grid[(position.r - 1) / 2][position.c / 2]))
-				continue;
+	/* The start tile joins whichever neighbours have a pipe pointing back at it */
+	void connect_start() {
+		auto &start = cell(*start_);
+		for (int direction = 0; direction < 4; ++direction) {
+			if (start_->can_move(direction, num_rows_, num_columns_) && (cell(start_->move(direction)) & bit(Grid_Direction{direction}.reverse())))
+				start |= bit(direction);
 		}
-
-		if (position.r > 0)
-			to_visit.push_back({Grid_Position{position.r - 1, position.c}});
-		if (position.r < visited.size() - 1)
-			to_visit.push_back({Grid_Position{position.r + 1, position.c}});
-		if (position.c > 0)
-			to_visit.push_back({Grid_Position{position.r, position.c - 1}});
-		if (position.c < visited[0].size() - 1)
-			to_visit.push_back({Grid_Position{position.r, position.c + 1}});
+		if (std::popcount(start) != 2)
+			throw std::logic_error{"The start tile must join exactly two pipes"};
 	}
-	return grid.size() * grid[0].size() - non_enclosed_count - count_loop_size(grid);
-}
+};
 
 int main(int argc, char *argv[]) {
 	const auto part = select_part(argc, argv);
-	auto grid = read_grid(std::cin, [](auto c) { return Tile{c}; });
-	for (std::size_t row = 0; row < grid.size(); ++row) {
-		for (std::size_t column = 0; column < grid[0].size(); ++column)
-			grid[row][column].link_neighbors(grid, row, column);
+	const auto arguments = extra_arguments(argc, argv);
+	if (!arguments.empty() && arguments[0] != "scanline") {
+		std::cerr << argv[0] << ": invalid argument '" << arguments[0] << "'" << std::endl;
+		return 1;
 	}
 
-	find_start(grid).calculate_loop_distances();
-	std::cout << (part == 1 ? find_max_distance(grid) : count_enclosed(grid)) << std::endl;
+	auto maze = Pipe_Maze::create_from_stream(std::cin);
+	const auto loop = maze.trace_loop();
+	if (part == 1)
+		std::cout << loop.length / 2 << std::endl;
+	else
+		std::cout << (arguments.empty() ? loop.enclosed_tiles() : maze.count_enclosed_by_scanline()) << std::endl;
 	return 0;
 }
\ No newline at end of file
@@ -1,74 +1,81 @@
 #include "common.h"
-#include <map>
-#include <numeric>
+#include <charconv>
 
 struct Universe {
 
 	explicit Universe(const std::vector<std::vector<char>> &grid) {
-		height_ = grid.size();
-		width_ = grid[0].size();
+		std::vector<bool> occupied_rows(grid.size()), occupied_columns(grid[0].size());
+		/* Galaxy coordinates per axis, rows in scan order and so ascending */
+		std::vector<std::size_t> galaxy_rows, galaxy_columns;
 		for (std::size_t r = 0; r < grid.size(); ++r) {
 			for (std::size_t c = 0; c < grid[0].size(); ++c) {
 				if (grid[r][c] == '#') {
-					galaxy_locations_.push_back(Grid_Position{r, c});
-					galaxy_column_order_.push_back(c);
+					galaxy_rows.push_back(r);
+					galaxy_columns.push_back(c);
+					occupied_rows[r] = occupied_columns[c] = true;
 				}
 			}
 		}
-		std::ranges::sort(galaxy_column_order_);
-		galaxy_column_order_.erase(std::ranges::unique(galaxy_column_order_).begin(), galaxy_column_order_.end());
-	}
+		std::ranges::sort(galaxy_columns);
+		unexpanded_sum_ = sum_of_gaps(galaxy_rows) + sum_of_gaps(galaxy_columns);
 
-	[[nodiscard]] std::vector<std::size_t> galaxy_distances() const {
-		std::vector<std::size_t> distances;
-		ranges_foreach_combination(galaxy_locations_, [&distances](const auto &lhs, const auto &rhs) {
-			distances.push_back(galaxy_distance(lhs, rhs));
-		});
-		return distances;
+		/* Counts of empty lines before a coordinate ascend with it, so their gaps are the empty lines in between */
+		const auto empty_rows_before = count_empty_before(occupied_rows);
+		const auto empty_columns_before = count_empty_before(occupied_columns);
+		for (auto &r : galaxy_rows)
+			r = empty_rows_before[r];
+		for (auto &c : galaxy_columns)
+			c = empty_columns_before[c];
+		empty_crossings_ = sum_of_gaps(galaxy_rows) + sum_of_gaps(galaxy_columns);
 	}
 
-	void expand(std::size_t n) {
-		ssize_t last_r{-1};
-		std::size_t inc{0};
-		for (auto &[r, c] : galaxy_locations_) {
-			const auto dist = r - last_r;
-			if (dist > 1)
-				inc += (dist - 1) * n;
-			last_r = static_cast<ssize_t>(r);
-			r += inc;
-		}
-
-		ssize_t last_c{-1};
-		inc = 0;
-		std::unordered_map<std::size_t, std::size_t> incs;
-		for (auto c : galaxy_column_order_) {
-			const auto dist = c - last_c;
-			if (dist > 1)
-				inc += (dist - 1) * n;
-			last_c = static_cast<ssize_t>(c);
-			incs[c] = inc;
-		}
-
-		for (auto &[r, c] : galaxy_locations_)
-			c += incs[c];
+	/* The distance sum is affine in the expansion factor: the unexpanded distances, plus factor - 1 for every empty
+	 * row or column crossed by each pair */
+	[[nodiscard]] uint128 sum_of_distances(std::size_t expansion_factor) const noexcept {
+		return uint128{unexpanded_sum_} + uint128{expansion_factor - 1} * empty_crossings_;
 	}
 
 private:
-	[[nodiscard]] static std::size_t galaxy_distance(const Grid_Position &lhs, const Grid_Position &rhs) noexcept {
-		return std::abs(static_cast<long>(lhs.r) - static_cast<long>(rhs.r)) + std::abs(static_cast<long>(lhs.c) - static_cast<long>(rhs.c));
+	std::size_t unexpanded_sum_{0};
+	std::size_t empty_crossings_{0};
+
+	[[nodiscard]] static std::vector<std::size_t> count_empty_before(const std::vector<bool> &occupied) {
+		std::vector<std::size_t> empty_before(occupied.size());
+		for (std::size_t i = 1; i < occupied.size(); ++i)
+			empty_before[i] = empty_before[i - 1] + !occupied[i - 1];
+		return empty_before;
 	}
 
-	std::size_t width_, height_;
-	std::vector<Grid_Position> galaxy_locations_;
-	std::vector<std::size_t> galaxy_column_order_;
+	/* Sum over all pairs of sorted values of their difference: each value is subtracted from every later one */
+	[[nodiscard]] static std::size_t sum_of_gaps(const std::vector<std::size_t> &sorted) noexcept {
+		std::size_t sum{0}, prefix{0};
+		for (std::size_t i = 0; i < sorted.size(); ++i) {
+			sum += sorted[i] * i - prefix;
+			prefix += sorted[i];
+		}
+		return sum;
+	}
 };
 
 int main(int argc, char *argv[]) {
 	const auto part = select_part(argc, argv);
-	Universe universe(read_grid(std::cin));
-	universe.expand(part == 1 ? 1 : 999999);
+	const Universe universe(read_grid(std::cin));
 
-	const auto distances = universe.galaxy_distances();
-	std::cout << std::accumulate(distances.begin(), distances.end(), std::size_t{0},
-								 [](auto sum, auto distance) { return sum + distance; }) << std::endl;
+	/* Any further arguments are expansion factors to answer instead of the part's own */
+	const auto arguments = extra_arguments(argc, argv);
+	if (arguments.empty()) {
+		std::cout << to_string(universe.sum_of_distances(part == 1 ? 2 : 1000000)) << std::endl;
+		return 0;
+	}
+	for (auto argument : arguments) {
+		std::size_t factor{0};
+		const auto [end, error] = std::from_chars(argument.data(), argument.data() + argument.size(), factor);
+		if (error != std::errc{} || end != argument.data() + argument.size() || factor == 0) {
+			std::cerr << argv[0] << ": invalid expansion factor '" << argument << "'" << std::endl;
+			return 1;
+		}
+		std::cout << to_string(universe.sum_of_distances(factor)) << '\n';
+	}
+	std::cout << std::flush;
+	return 0;
 }
\ No newline at end of file
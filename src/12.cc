@@ -1,20 +1,210 @@
 #include "common.h"
+#include <charconv>
+#include <cstdint>
+#include <exception>
 #include <numeric>
+#include <optional>
+#include <thread>
+#include <utility>
 
-struct Record : Token_Reader<Record> {
+/* 128-bit counts that refuse to wrap */
+struct Exact_Count {
+	uint128 value{0};
+
+	Exact_Count() = default;
+
+	explicit Exact_Count(std::uint64_t count) noexcept
+		: value{count} { }
+
+	Exact_Count &operator+=(const Exact_Count &other) {
+		if (value + other.value < value)
+			throw std::overflow_error{"Arrangement count exceeds 128 bits, count with 'big' or 'mod <p>' instead"};
+		value += other.value;
+		return *this;
+	}
+
+	[[nodiscard]] std::string to_string() const {
+		return ::to_string(value);
+	}
+};
+
+/* Counts modulo a modulus chosen before counting starts */
+struct Modular_Count {
+	static inline std::uint64_t modulus{1};
+	std::uint64_t value{0};
+
+	Modular_Count() = default;
+
+	explicit Modular_Count(std::uint64_t count) noexcept
+		: value{count % modulus} { }
+
+	/* Both terms are already reduced, so one subtraction does, arranged so that nothing wraps for moduli near 2^64 */
+	Modular_Count &operator+=(const Modular_Count &other) noexcept {
+		const auto headroom = modulus - other.value;
+		value = value >= headroom ? value - headroom : value + other.value;
+		return *this;
+	}
+
+	[[nodiscard]] std::string to_string() const {
+		return std::to_string(value);
+	}
+};
 
-	[[nodiscard]] std::size_t num_arrangements() const {
-		std::unordered_map<std::string, std::size_t> cache;
-		return num_arrangements(0, 0, cache);
+/* Arbitrary-precision counts, in little-endian base 10^9 limbs so that printing needs no division */
+struct Big_Count {
+	static constexpr std::uint32_t base{1000000000};
+	std::vector<std::uint32_t> limbs;
+
+	Big_Count() = default;
+
+	explicit Big_Count(std::uint64_t count) {
+		for (; count != 0; count /= base)
+			limbs.push_back(static_cast<std::uint32_t>(count % base));
+	}
+
+	Big_Count &operator+=(const Big_Count &other) {
+		if (limbs.size() < other.limbs.size())
+			limbs.resize(other.limbs.size());
+		std::uint32_t carry{0};
+		for (std::size_t i = 0; i < limbs.size() && (carry != 0 || i < other.limbs.size()); ++i) {
+			limbs[i] += carry + (i < other.limbs.size() ? other.limbs[i] : 0);
+			carry = limbs[i] >= base;
+			if (carry)
+				limbs[i] -= base;
+		}
+		if (carry)
+			limbs.push_back(carry);
+		return *this;
 	}
 
-	void unfold(std::size_t n) {
-		const auto condition_orig{condition_};
-		const auto group_sizes_orig{group_sizes_};
-		for (std::size_t i = 1; i < n; ++i) {
-			condition_ += "?" + condition_orig;
-			group_sizes_.insert(group_sizes_.end(), group_sizes_orig.begin(), group_sizes_orig.end());
+	[[nodiscard]] std::string to_string() const {
+		if (limbs.empty())
+			return "0";
+		auto digits = std::to_string(limbs.back());
+		for (auto limb = std::next(limbs.rbegin()); limb != limbs.rend(); ++limb) {
+			const auto chunk = std::to_string(*limb);
+			digits.append(9 - chunk.size(), '0').append(chunk);
 		}
+		return digits;
+	}
+};
+
+/* ways(g, i) = ways(g, i + 1) + ways(g + 1, i + size(g) + 1) if g fits at i, in a ring of columns zero off their band */
+template<typename CountT>
+struct Arrangement_Counter {
+	[[nodiscard]] CountT count(std::string_view condition, const std::vector<std::size_t> &group_sizes, std::size_t copies) {
+		condition_ = condition;
+		group_sizes_ = &group_sizes;
+		period_ = condition.size() + 1;
+		length_ = copies * period_ - 1;
+		num_groups_ = copies * group_sizes.size();
+		if (group_sizes.empty())
+			return CountT{condition.find('#') == std::string_view::npos};
+
+		operational_before_.assign(period_, 0);
+		for (std::size_t i = 0; i < condition.size(); ++i)
+			operational_before_[i + 1] = operational_before_[i] + (condition[i] == '.');
+		const auto total_need = copies * std::accumulate(group_sizes.begin(), group_sizes.end(), group_sizes.size());
+
+		/* Whether a group of each size fits from each offset, the same in every copy */
+		fits_.resize(period_ * group_sizes.size());
+		for (std::size_t offset = 0; offset < period_; ++offset) {
+			for (std::size_t pattern = 0; pattern < group_sizes.size(); ++pattern) {
+				const auto end = offset + group_sizes[pattern];
+				fits_[offset * group_sizes.size() + pattern] = operational_before(end) == operational_before(offset) && spring(end % period_) != '#';
+			}
+		}
+
+		/* Positions length and length + 1 hold the one way to place no more groups; impossible moves read no_ways */
+		const auto ring_size = std::ranges::max(group_sizes) + 2;
+		columns_.resize(ring_size + 1);
+		bands_.assign(ring_size, {1, 0});
+		for (auto &column : columns_)
+			column.assign(num_groups_ + 2, CountT{});
+		const auto *no_ways = columns_[ring_size].data();
+		for (auto position : {length_, length_ + 1}) {
+			columns_[position % ring_size][num_groups_] = CountT{1};
+			bands_[position % ring_size] = {num_groups_, num_groups_};
+		}
+
+		end_columns_.resize(group_sizes.size());
+		auto offset = condition.size(), slot = length_ % ring_size;
+		Group_Cursor first{num_groups_, 0, total_need}, last{first};
+		for (auto i = length_; i-- > 0; ) {
+			const auto next_slot = slot;
+			slot = slot == 0 ? ring_size - 1 : slot - 1;
+			offset = (offset == 0 ? period_ : offset) - 1;
+
+			/* Where the next group could start if one of each size fits here */
+			const auto *fits = &fits_[offset * group_sizes.size()];
+			for (std::size_t pattern = 0; pattern < group_sizes.size(); ++pattern) {
+				const auto end_slot = slot + group_sizes[pattern] + 1;
+				end_columns_[pattern] = fits[pattern] && i + group_sizes[pattern] <= length_
+										? columns_[end_slot < ring_size ? end_slot : end_slot - ring_size].data() : no_ways;
+			}
+
+			/* Both ends of the band only move down as the position does */
+			while (last.need > i)
+				last = previous(last);
+			while (first.group > 0) {
+				const auto candidate = previous(first);
+				if (candidate.need + length_ + 1 < total_need + i)
+					break;
+				first = candidate;
+			}
+
+			/* Zero what left the band */
+			auto &column = columns_[slot];
+			const auto [stale_first, stale_last] = std::exchange(bands_[slot], {first.group, last.group});
+			for (auto group = stale_first; group < first.group && group <= stale_last; ++group)
+				column[group] = CountT{};
+			for (auto group = std::max(stale_first, last.group + 1); group <= stale_last; ++group)
+				column[group] = CountT{};
+			const auto *next_column = spring(offset) != '#' ? columns_[next_slot].data() : no_ways;
+			for (auto group = first.group, pattern = first.pattern; group <= last.group; ++group) {
+				column[group] = next_column[group];
+				column[group] += end_columns_[pattern][group + 1];
+				if (++pattern == group_sizes.size())
+					pattern = 0;
+			}
+		}
+		return columns_[slot][0];
+	}
+
+private:
+	std::string_view condition_;
+	const std::vector<std::size_t> *group_sizes_{nullptr};
+	std::size_t period_{0}, length_{0}, num_groups_{0};
+	std::vector<std::size_t> operational_before_;
+	std::vector<std::vector<CountT>> columns_;
+	std::vector<std::pair<std::size_t, std::size_t>> bands_;
+	std::vector<char> fits_;
+	std::vector<const CountT *> end_columns_;
+
+	[[nodiscard]] char spring(std::size_t offset) const noexcept {
+		return offset == condition_.size() ? '?' : condition_[offset];
+	}
+
+	[[nodiscard]] std::size_t operational_before(std::size_t position) const noexcept {
+		return position / period_ * operational_before_.back() + operational_before_[position % period_];
+	}
+
+	/* A group, its index into the record's own groups and the springs the groups before it need */
+	struct Group_Cursor {
+		std::size_t group, pattern, need;
+	};
+
+	[[nodiscard]] Group_Cursor previous(const Group_Cursor &cursor) const noexcept {
+		const auto pattern = (cursor.pattern == 0 ? group_sizes_->size() : cursor.pattern) - 1;
+		return {cursor.group - 1, pattern, cursor.need - (*group_sizes_)[pattern] - 1};
+	}
+};
+
+struct Record : Token_Reader<Record> {
+
+	template<typename CountT>
+	[[nodiscard]] CountT num_arrangements(Arrangement_Counter<CountT> &counter, std::size_t copies) const {
+		return counter.count(condition_, group_sizes_, copies);
 	}
 
 	void read_token(const std::string &token) final {
@@ -31,48 +221,79 @@ struct Record : Token_Reader<Record> {
 private:
 	std::string condition_;
 	std::vector<std::size_t> group_sizes_;
+};
 
-	[[nodiscard]] std::string cache_key(std::size_t condition_start, std::size_t group_idx) const {
-		auto key = condition_.substr(condition_start);
-		for (auto group_it = group_sizes_.begin() + static_cast<ssize_t>(group_idx); group_it != group_sizes_.end(); ++group_it)
-			key += "," + std::to_string(*group_it);
-		return key;
-	}
-
-	[[nodiscard]] std::size_t num_arrangements(std::size_t condition_start, std::size_t group_idx, std::unordered_map<std::string, std::size_t> &cache) const {
-		if (condition_start > 0 && condition_[condition_start - 1] == '#')
-			return 0;
-		if (group_idx == group_sizes_.size())
-			return std::none_of(condition_.begin() + static_cast<ssize_t>(condition_start), condition_.end(), [](auto c) { return c == '#'; });
-		if (condition_start >= condition_.size())
-			return 0;
-
-		const auto key = cache_key(condition_start, group_idx);
-		auto cache_it = cache.find(key);
-		if (cache_it == cache.end()) {
-			std::size_t count{0};
-			for (auto condition_idx = condition_start; condition_idx <= condition_.size() - group_sizes_[group_idx]; ++condition_idx) {
-				const auto group_start = condition_.begin() + static_cast<ssize_t>(condition_idx);
-				if (std::all_of(group_start, group_start + static_cast<ssize_t>(group_sizes_[group_idx]),
-								[](auto c) { return c == '#' || c == '?'; }))
-					count += num_arrangements(condition_idx + group_sizes_[group_idx] + 1, group_idx + 1, cache);
-				if (condition_[condition_idx] == '#')
-					break;
+/* Reads records in batches and spreads each batch across threads, each with its own counter */
+template<typename CountT>
+[[nodiscard]] static CountT sum_arrangements(std::istream &in, std::size_t copies) {
+	static constexpr std::size_t batch_size{1 << 14};
+	const std::size_t num_threads{std::max(1u, std::thread::hardware_concurrency())};
+	std::vector<Arrangement_Counter<CountT>> counters(num_threads);
+	std::vector<Record> batch;
+	CountT sum{};
+	while (has_input(in)) {
+		batch.clear();
+		while (batch.size() < batch_size && has_input(in))
+			batch.push_back(Record::create_from_stream(in));
+
+		std::vector<CountT> sums(num_threads);
+		std::vector<std::exception_ptr> errors(num_threads);
+		{
+			std::vector<std::jthread> threads;
+			for (std::size_t thread = 0; thread < num_threads; ++thread) {
+				threads.emplace_back([&, thread] {
+					try {
+						for (auto record = thread; record < batch.size(); record += num_threads)
+							sums[thread] += batch[record].num_arrangements(counters[thread], copies);
+					} catch (...) {
+						errors[thread] = std::current_exception();
+					}
+				});
 			}
-			cache_it = cache.emplace(key, count).first;
 		}
-		return cache_it->second;
+		for (std::size_t thread = 0; thread < num_threads; ++thread) {
+			if (errors[thread])
+				std::rethrow_exception(errors[thread]);
+			sum += sums[thread];
+		}
 	}
-};
+	return sum;
+}
+
+[[nodiscard]] static std::optional<std::uint64_t> parse_positive(std::string_view argument) {
+	std::uint64_t value{0};
+	const auto [end, error] = std::from_chars(argument.data(), argument.data() + argument.size(), value);
+	if (error != std::errc{} || end != argument.data() + argument.size() || value == 0)
+		return std::nullopt;
+	return value;
+}
 
 int main(int argc, char *argv[]) {
 	const auto part = select_part(argc, argv);
-	auto records = read_as<Record>(std::cin);
-	if (part == 2) {
-		for (auto &record : records)
-			record.unfold(5);
+
+	/* Optionally: an unfold factor replacing the part's own, then how to count: 'exact' (128-bit, the default),
+	 * 'big' (arbitrary precision) or 'mod <p>' */
+	const auto arguments = extra_arguments(argc, argv);
+	const auto copies = arguments.empty() ? std::optional<std::uint64_t>{part == 1 ? 1 : 5} : parse_positive(arguments[0]);
+	const std::string_view mode{arguments.size() > 1 ? arguments[1] : "exact"};
+	const auto modulus = mode == "mod" && arguments.size() == 3 ? parse_positive(arguments[2]) : std::nullopt;
+	if (!copies || (mode != "exact" && mode != "big" && !modulus) || arguments.size() > (modulus ? 3 : 2)) {
+		std::cerr << "Usage: " << argv[0] << " <1|2> [unfold factor] [exact|big|mod <p>]" << std::endl;
+		return 1;
+	}
+
+	if (mode == "big") {
+		std::cout << sum_arrangements<Big_Count>(std::cin, *copies).to_string() << std::endl;
+	} else if (modulus) {
+		Modular_Count::modulus = *modulus;
+		std::cout << sum_arrangements<Modular_Count>(std::cin, *copies).to_string() << std::endl;
+	} else {
+		try {
+			std::cout << sum_arrangements<Exact_Count>(std::cin, *copies).to_string() << std::endl;
+		} catch (const std::overflow_error &error) {
+			std::cerr << argv[0] << ": " << error.what() << std::endl;
+			return 1;
+		}
 	}
-	std::cout << std::accumulate(records.begin(), records.end(), std::size_t{0},
-								 [](auto sum, const auto &record) { return sum + record.num_arrangements(); }) << std::endl;
 	return 0;
 }
\ No newline at end of file
@@ -2,26 +2,26 @@
 #include <numeric>
 
 struct Box {
-	Box() = default;
+	constexpr Box() = default;
 
-	explicit Box(std::size_t number) noexcept
+	constexpr explicit Box(std::size_t number) noexcept
 			: number_{number} { }
 
-	[[nodiscard]] std::size_t focusing_power() const noexcept {
+	[[nodiscard]] constexpr std::size_t focusing_power() const noexcept {
 		std::size_t power{0};
 		for (std::size_t slot = 0; slot < lenses_.size(); ++slot)
 			power += number_ * (slot + 1) * lenses_[slot].length;
 		return power;
 	}
 
-	void add_lens(const std::string &label, int length) {
+	constexpr void add_lens(std::string_view label, int length) {
 		if (auto lens_it = find_lens(label); lens_it != lenses_.end())
 			lens_it->length = length;
 		else
-			lenses_.push_back(Lens{label, length});
+			lenses_.push_back(Lens{std::string{label}, length});
 	}
 
-	void remove_lens(const std::string &label) {
+	constexpr void remove_lens(std::string_view label) {
 		if (auto lens_it = find_lens(label); lens_it != lenses_.end())
 			lenses_.erase(lens_it);
 	}
@@ -35,37 +35,37 @@ private:
 	std::size_t number_{};
 	std::vector<Lens> lenses_;
 
-	decltype(lenses_)::iterator find_lens(const std::string &label) {
+	constexpr decltype(lenses_)::iterator find_lens(std::string_view label) {
 		return std::ranges::find_if(lenses_, [&label](const auto &lens) { return lens.label == label; });
 	}
 };
 
-[[nodiscard]] static std::size_t calculate_hash(const std::string &str) noexcept {
+[[nodiscard]] static constexpr std::size_t calculate_hash(std::string_view str) noexcept {
 	std::size_t val{0};
 	for (auto c : str)
 		val = ((val + c) * 17) % 256;
 	return val;
 }
 
-[[nodiscard]] static std::size_t hash_sum(const std::vector<std::string> &init_steps) noexcept {
+[[nodiscard]] static constexpr std::size_t hash_sum(const std::vector<std::string_view> &init_steps) noexcept {
 	return std::accumulate(init_steps.begin(), init_steps.end(), std::size_t{0},
 						   [](auto sum, const auto &step) { return sum + calculate_hash(step); });
 }
 
-[[nodiscard]] std::size_t focusing_power(const std::vector<std::string> &init_steps) {
+[[nodiscard]] constexpr std::size_t focusing_power(const std::vector<std::string_view> &init_steps) {
 	std::array<Box, 256> boxes;
 	for (std::size_t i = 0; i < boxes.size(); ++i)
 		boxes[i] = Box{i + 1};
 
 	for (const auto &step : init_steps) {
 		auto dash_pos = step.find('-');
-		if (dash_pos != std::string::npos) {
+		if (dash_pos != std::string_view::npos) {
 			const auto label = step.substr(0, dash_pos);
 			boxes[calculate_hash(label)].remove_lens(label);
 		} else {
 			auto equal_pos = step.find('=');
 			const auto label = step.substr(0, equal_pos);
-			const auto length = std::stoi(step.substr(equal_pos + 1));
+			const auto length = parse_integer<int>(step.substr(equal_pos + 1));
 			boxes[calculate_hash(label)].add_lens(label, length);
 		}
 	}
@@ -74,10 +74,18 @@ private:
 						   [](auto sum, const auto &box) { return sum + box.focusing_power(); });
 }
 
+[[nodiscard]] static constexpr std::size_t solve(std::string_view input, uint part) {
+	const auto init_steps = split_view(input.substr(0, input.find('\n')), ',');
+	return part == 1 ? hash_sum(init_steps) : focusing_power(init_steps);
+}
+
 int main(int argc, char *argv[]) {
 	const auto part = select_part(argc, argv);
-
-	const auto init_steps = read_tokens(read_line(std::cin), ',');
-	std::cout << (part == 1 ? hash_sum(init_steps) : focusing_power(init_steps)) << std::endl;
+#ifdef ADVENT_EMBEDDED_INPUT
+	static constexpr std::array answers{solve(embedded_input, 1), solve(embedded_input, 2)};
+	std::cout << answers[part - 1] << std::endl;
+#else
+	std::cout << solve(read_input(std::cin), part) << std::endl;
+#endif
 	return 0;
 }
\ No newline at end of file
@@ -0,0 +1,409 @@
+/*
+ * Size-class, thread-caching replacement for the global operator new/delete.
+ *
+ * Small requests (up to 32 KiB) are rounded up to one of 40 size classes and served from per-thread free lists, which
+ * are refilled from and drained to a mutex-protected central heap in batches. The central heap carves fixed-size spans
+ * out of large mmapped arenas, each span holding blocks of a single size class. Larger or over-aligned requests get
+ * their own mapping, rounded up to a size class of the same shape. Freed mappings are cached per class for reuse, up to
+ * a total size, so that growing vectors don't pay for a fresh mapping and its page faults on every doubling. Every
+ * allocation lives inside a span-aligned region whose header records how it was allocated, so operator delete never
+ * needs the size. Only allocations aligned to a whole span start on a span boundary; their header sits in the span
+ * below.
+ *
+ * Defining ADVENT_HUGE_PAGES advises the kernel to back arenas and large mappings with transparent huge pages.
+ */
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstdint>
+#include <mutex>
+#include <new>
+#include <sys/mman.h>
+
+namespace {
+
+constexpr std::size_t span_size{std::size_t{1} << 18};
+constexpr std::size_t arena_size{std::size_t{1} << 26};
+constexpr std::size_t header_size{64};
+constexpr std::size_t page_size{std::size_t{1} << 12};
+constexpr std::size_t huge_page_size{std::size_t{1} << 21};
+constexpr std::size_t max_small_size{std::size_t{1} << 15};
+constexpr std::size_t max_small_alignment{header_size};
+constexpr std::size_t num_size_classes{40};
+constexpr std::uint32_t large_class{~std::uint32_t{0}};
+constexpr std::size_t max_large_size{std::size_t{1} << 46};
+constexpr std::size_t max_cached_bytes{std::size_t{1} << 28};
+
+/* --- Size classes --- */
+
+/* Classes step by 16 bytes up to 128, then by quarters of each power of two, up to max_small_size for blocks and
+ * max_large_size for mappings */
+[[nodiscard]] constexpr std::size_t size_class(std::size_t size) noexcept {
+	if (size <= 128)
+		return size == 0 ? 0 : (size - 1) / 16;
+	const auto exponent = static_cast<std::size_t>(std::bit_width(size - 1)) - 1;
+	const auto quarter = std::size_t{1} << (exponent - 2);
+	const auto quarters = (size - (std::size_t{1} << exponent) + quarter - 1) / quarter;
+	return 8 + (exponent - 7) * 4 + quarters - 1;
+}
+
+[[nodiscard]] constexpr std::size_t class_size(std::size_t size_class) noexcept {
+	if (size_class < 8)
+		return (size_class + 1) * 16;
+	const auto exponent = 7 + (size_class - 8) / 4;
+	return (std::size_t{1} << exponent) + ((size_class - 8) % 4 + 1) * (std::size_t{1} << (exponent - 2));
+}
+
+[[nodiscard]] constexpr std::size_t batch_size(std::size_t size_class) noexcept {
+	return std::clamp(std::size_t{1} << 16 >> std::bit_width(class_size(size_class) - 1), std::size_t{2}, std::size_t{64});
+}
+
+static_assert(size_class(max_small_size) == num_size_classes - 1);
+static_assert(class_size(num_size_classes - 1) == max_small_size);
+static_assert(class_size(size_class(129)) == 160 && class_size(size_class(1000)) == 1024);
+
+constexpr std::size_t num_large_classes{size_class(max_large_size) + 1};
+constexpr std::size_t uncached_class{num_large_classes};
+static_assert(class_size(size_class(max_small_size + 1)) % page_size == 0);
+
+/* --- Page mappings --- */
+
+struct alignas(header_size) Span_Header {
+	std::uint32_t size_class;
+	std::size_t mapping_size;
+	/* Large mappings only: the class their size was rounded from, the next cached mapping once freed, and how far into
+	 * the mapping the header sits */
+	std::size_t large_size_class{0};
+	Span_Header *next_cached{nullptr};
+	std::size_t mapping_offset{0};
+};
+
+struct Free_Block {
+	Free_Block *next;
+};
+
+[[nodiscard]] void *map_pages(std::size_t size, std::size_t alignment) {
+	auto *raw = mmap(nullptr, size + alignment, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+	if (raw == MAP_FAILED)
+		throw std::bad_alloc{};
+
+	const auto start = reinterpret_cast<std::uintptr_t>(raw);
+	const auto aligned = (start + alignment - 1) & ~(alignment - 1);
+	if (aligned > start)
+		munmap(raw, aligned - start);
+	if (start + alignment > aligned)
+		munmap(reinterpret_cast<void *>(aligned + size), start + alignment - aligned);
+#ifdef ADVENT_HUGE_PAGES
+	if (size >= huge_page_size)
+		madvise(reinterpret_cast<void *>(aligned), size, MADV_HUGEPAGE);
+#endif
+	return reinterpret_cast<void *>(aligned);
+}
+
+[[nodiscard]] Span_Header &span_header(void *ptr) noexcept {
+	const auto address = reinterpret_cast<std::uintptr_t>(ptr);
+	return *reinterpret_cast<Span_Header *>(address % span_size == 0 ? address - span_size : address & ~(span_size - 1));
+}
+
+/* --- Large mappings --- */
+
+struct Large_Cache {
+	[[nodiscard]] Span_Header *take(std::size_t large_size_class) noexcept {
+		std::lock_guard lock{mutex_};
+		auto *header = free_lists_[large_size_class];
+		if (header != nullptr) {
+			free_lists_[large_size_class] = header->next_cached;
+			cached_bytes_ -= header->mapping_size;
+		}
+		return header;
+	}
+
+	/* Keeps a freed mapping unless the cache is full, in which case the caller unmaps it */
+	[[nodiscard]] bool give(Span_Header &header) noexcept {
+		if (header.large_size_class == uncached_class)
+			return false;
+		std::lock_guard lock{mutex_};
+		if (cached_bytes_ + header.mapping_size > max_cached_bytes)
+			return false;
+		header.next_cached = free_lists_[header.large_size_class];
+		free_lists_[header.large_size_class] = &header;
+		cached_bytes_ += header.mapping_size;
+		return true;
+	}
+
+private:
+	std::mutex mutex_;
+	std::array<Span_Header *, num_large_classes> free_lists_{};
+	std::size_t cached_bytes_{0};
+};
+
+constinit Large_Cache large_cache;
+
+/* The block starts on a span boundary, so its header goes at the start of the span below it */
+[[nodiscard]] void *allocate_span_aligned(std::size_t size, std::size_t alignment) {
+	const auto mapping_size = (alignment + size + page_size - 1) & ~(page_size - 1);
+	auto *mapping = static_cast<char *>(map_pages(mapping_size, alignment));
+	const auto mapping_offset = alignment - span_size;
+	new (mapping + mapping_offset) Span_Header{large_class, mapping_size, uncached_class, nullptr, mapping_offset};
+	return mapping + alignment;
+}
+
+[[nodiscard]] void *allocate_large(std::size_t size, std::size_t alignment) {
+	if (size > max_large_size || alignment > max_large_size)
+		throw std::bad_alloc{};
+	if (alignment >= span_size)
+		return allocate_span_aligned(size, alignment);
+	const auto offset = std::max(header_size, alignment);
+	const auto large_size_class = size_class(offset + size);
+	if (auto *header = large_cache.take(large_size_class))
+		return reinterpret_cast<char *>(header) + offset;
+
+	auto mapping_size = class_size(large_size_class);
+	auto mapping_alignment = span_size;
+#ifdef ADVENT_HUGE_PAGES
+	if (mapping_size >= huge_page_size) {
+		mapping_size = (mapping_size + huge_page_size - 1) & ~(huge_page_size - 1);
+		mapping_alignment = huge_page_size;
+	}
+#endif
+	auto *header = new (map_pages(mapping_size, mapping_alignment)) Span_Header{large_class, mapping_size, large_size_class};
+	return reinterpret_cast<char *>(header) + offset;
+}
+
+/* --- Central heap --- */
+
+struct Central_Heap {
+	/* Removes up to `count` blocks of the given class, carving fresh blocks from a span if none are free */
+	[[nodiscard]] Free_Block *take_batch(std::size_t size_class, std::size_t &count) {
+		std::lock_guard lock{mutex_};
+		if (free_lists_[size_class] == nullptr)
+			carve_blocks(size_class, count);
+
+		auto *head = free_lists_[size_class];
+		auto *tail = head;
+		std::size_t taken{1};
+		for (; taken < count && tail->next != nullptr; ++taken)
+			tail = tail->next;
+		free_lists_[size_class] = tail->next;
+		tail->next = nullptr;
+		count = taken;
+		return head;
+	}
+
+	void give_batch(std::size_t size_class, Free_Block *head, Free_Block *tail) noexcept {
+		std::lock_guard lock{mutex_};
+		tail->next = free_lists_[size_class];
+		free_lists_[size_class] = head;
+	}
+
+private:
+	std::mutex mutex_;
+	std::array<Free_Block *, num_size_classes> free_lists_{};
+	std::uintptr_t arena_next_{0};
+	std::uintptr_t arena_end_{0};
+
+	std::array<std::uintptr_t, num_size_classes> carve_next_{};
+	std::array<std::uintptr_t, num_size_classes> carve_end_{};
+
+	/* Blocks are threaded onto the free list a batch at a time so untouched span pages stay unbacked */
+	void carve_blocks(std::size_t size_class, std::size_t count) {
+		const auto block_size = class_size(size_class);
+		if (carve_next_[size_class] + block_size > carve_end_[size_class]) {
+			if (arena_next_ == arena_end_) {
+				arena_next_ = reinterpret_cast<std::uintptr_t>(map_pages(arena_size, span_size));
+				arena_end_ = arena_next_ + arena_size;
+			}
+			new (reinterpret_cast<void *>(arena_next_)) Span_Header{static_cast<std::uint32_t>(size_class), span_size};
+			carve_next_[size_class] = arena_next_ + header_size;
+			carve_end_[size_class] = arena_next_ + span_size;
+			arena_next_ += span_size;
+		}
+
+		Free_Block *head{nullptr};
+		for (; count > 0 && carve_next_[size_class] + block_size <= carve_end_[size_class]; --count) {
+			auto *block = reinterpret_cast<Free_Block *>(carve_next_[size_class]);
+			block->next = head;
+			head = block;
+			carve_next_[size_class] += block_size;
+		}
+		free_lists_[size_class] = head;
+	}
+};
+
+constinit Central_Heap central_heap;
+
+/* --- Thread caches --- */
+
+constinit thread_local bool thread_cache_destroyed{false};
+
+struct Thread_Cache {
+	~Thread_Cache() {
+		for (std::size_t size_class = 0; size_class < num_size_classes; ++size_class) {
+			if (free_lists_[size_class] != nullptr) {
+				auto *tail = free_lists_[size_class];
+				while (tail->next != nullptr)
+					tail = tail->next;
+				central_heap.give_batch(size_class, free_lists_[size_class], tail);
+			}
+		}
+		thread_cache_destroyed = true;
+	}
+
+	[[nodiscard]] void *allocate(std::size_t size_class) {
+		if (free_lists_[size_class] == nullptr) {
+			std::size_t count{batch_size(size_class)};
+			free_lists_[size_class] = central_heap.take_batch(size_class, count);
+			counts_[size_class] = count;
+		}
+		auto *block = free_lists_[size_class];
+		free_lists_[size_class] = block->next;
+		--counts_[size_class];
+		return block;
+	}
+
+	void deallocate(void *ptr, std::size_t size_class) noexcept {
+		auto *block = static_cast<Free_Block *>(ptr);
+		block->next = free_lists_[size_class];
+		free_lists_[size_class] = block;
+		if (++counts_[size_class] > 2 * batch_size(size_class)) {
+			auto *head = free_lists_[size_class];
+			auto *tail = head;
+			for (std::size_t i = 1; i < batch_size(size_class); ++i)
+				tail = tail->next;
+			free_lists_[size_class] = tail->next;
+			counts_[size_class] -= batch_size(size_class);
+			central_heap.give_batch(size_class, head, tail);
+		}
+	}
+
+private:
+	std::array<Free_Block *, num_size_classes> free_lists_{};
+	std::array<std::size_t, num_size_classes> counts_{};
+};
+
+thread_local Thread_Cache thread_cache;
+
+/* --- Entry points --- */
+
+[[nodiscard]] void *allocate(std::size_t size, std::size_t alignment = __STDCPP_DEFAULT_NEW_ALIGNMENT__) {
+	if (size > max_small_size || alignment > max_small_alignment)
+		return allocate_large(size, alignment);
+
+	/* Power-of-two classes keep every block aligned to its size within a span */
+	if (alignment > __STDCPP_DEFAULT_NEW_ALIGNMENT__)
+		size = std::bit_ceil(std::max(size, alignment));
+
+	const auto size_class_idx = size_class(size);
+	if (thread_cache_destroyed) {
+		std::size_t count{1};
+		return central_heap.take_batch(size_class_idx, count);
+	}
+	return thread_cache.allocate(size_class_idx);
+}
+
+[[nodiscard]] void *allocate_nothrow(std::size_t size, std::size_t alignment = __STDCPP_DEFAULT_NEW_ALIGNMENT__) noexcept {
+	try {
+		return allocate(size, alignment);
+	} catch (const std::bad_alloc &) {
+		return nullptr;
+	}
+}
+
+void deallocate(void *ptr) noexcept {
+	if (ptr == nullptr)
+		return;
+
+	auto &header = span_header(ptr);
+	if (header.size_class == large_class) {
+		if (!large_cache.give(header))
+			munmap(reinterpret_cast<char *>(&header) - header.mapping_offset, header.mapping_size);
+	} else if (thread_cache_destroyed) {
+		auto *block = static_cast<Free_Block *>(ptr);
+		central_heap.give_batch(header.size_class, block, block);
+	} else {
+		thread_cache.deallocate(ptr, header.size_class);
+	}
+}
+
+}
+
+void *operator new(std::size_t size) {
+	return allocate(size);
+}
+
+void *operator new[](std::size_t size) {
+	return allocate(size);
+}
+
+void *operator new(std::size_t size, const std::nothrow_t &) noexcept {
+	return allocate_nothrow(size);
+}
+
+void *operator new[](std::size_t size, const std::nothrow_t &) noexcept {
+	return allocate_nothrow(size);
+}
+
+void *operator new(std::size_t size, std::align_val_t alignment) {
+	return allocate(size, static_cast<std::size_t>(alignment));
+}
+
+void *operator new[](std::size_t size, std::align_val_t alignment) {
+	return allocate(size, static_cast<std::size_t>(alignment));
+}
+
+void *operator new(std::size_t size, std::align_val_t alignment, const std::nothrow_t &) noexcept {
+	return allocate_nothrow(size, static_cast<std::size_t>(alignment));
+}
+
+void *operator new[](std::size_t size, std::align_val_t alignment, const std::nothrow_t &) noexcept {
+	return allocate_nothrow(size, static_cast<std::size_t>(alignment));
+}
+
+void operator delete(void *ptr) noexcept {
+	deallocate(ptr);
+}
+
+void operator delete[](void *ptr) noexcept {
+	deallocate(ptr);
+}
+
+void operator delete(void *ptr, std::size_t) noexcept {
+	deallocate(ptr);
+}
+
+void operator delete[](void *ptr, std::size_t) noexcept {
+	deallocate(ptr);
+}
+
+void operator delete(void *ptr, std::align_val_t) noexcept {
+	deallocate(ptr);
+}
+
+void operator delete[](void *ptr, std::align_val_t) noexcept {
+	deallocate(ptr);
+}
+
+void operator delete(void *ptr, std::size_t, std::align_val_t) noexcept {
+	deallocate(ptr);
+}
+
+void operator delete[](void *ptr, std::size_t, std::align_val_t) noexcept {
+	deallocate(ptr);
+}
+
+void operator delete(void *ptr, const std::nothrow_t &) noexcept {
+	deallocate(ptr);
+}
+
+void operator delete[](void *ptr, const std::nothrow_t &) noexcept {
+	deallocate(ptr);
+}
+
+void operator delete(void *ptr, std::align_val_t, const std::nothrow_t &) noexcept {
+	deallocate(ptr);
+}
+
+void operator delete[](void *ptr, std::align_val_t, const std::nothrow_t &) noexcept {
+	deallocate(ptr);
+}
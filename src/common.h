@@ -7,6 +7,7 @@
 #include <iterator>
 #include <sstream>
 #include <string>
+#include <string_view>
 #include <type_traits>
 #include <vector>
 
@@ -61,6 +62,43 @@ std::vector<std::vector<int>> read_integer_grid(std::istream &in) {
 	return read_grid(in, [](char c) { return c - '0'; });
 }
 
+/* Streaming folds: each line or record is discarded once folded in, so memory use is independent of input length */
+
+template<typename T, typename FuncT>
+T accumulate_lines(std::istream &in, T init, const FuncT &func) {
+	for (std::string line; std::getline(in, line); )
+		init = func(std::move(init), line);
+	return init;
+}
+
+template<typename ReaderT, typename T, typename FuncT>
+T accumulate_as(std::istream &in, T init, const FuncT &func) {
+	while (has_input(in))
+		init = func(std::move(init), ReaderT::create_from_stream(in));
+	return init;
+}
+
+template<typename FuncT>
+constexpr void foreach_line(std::string_view in, const FuncT &func) {
+	while (!in.empty()) {
+		const auto end = std::min(in.find('\n'), in.size());
+		func(in.substr(0, end));
+		in.remove_prefix(std::min(end + 1, in.size()));
+	}
+}
+
+/* Splits the same way as read_tokens, without copying */
+[[nodiscard]] constexpr std::vector<std::string_view> split_view(std::string_view in, char delim = ' ') {
+	std::vector<std::string_view> tokens;
+	for (auto end = in.find(delim); end != std::string_view::npos; end = in.find(delim)) {
+		tokens.push_back(in.substr(0, end));
+		in.remove_prefix(end + 1);
+	}
+	if (!in.empty())
+		tokens.push_back(in);
+	return tokens;
+}
+
 template<typename ReaderT>
 std::vector<ReaderT> read_as(std::istream &in) {
 	std::vector<ReaderT> readers;
@@ -178,6 +216,20 @@ private:
 	}
 }
 
+/* Constant-evaluable std::stol: skips leading spaces and stops at the first non-digit */
+template<typename IntegralT = long> requires std::is_integral_v<IntegralT>
+[[nodiscard]] constexpr IntegralT parse_integer(std::string_view str) noexcept {
+	while (!str.empty() && str.front() == ' ')
+		str.remove_prefix(1);
+	const bool negative = !str.empty() && str.front() == '-';
+	if (negative)
+		str.remove_prefix(1);
+	IntegralT value{0};
+	for (; !str.empty() && is_digit(str.front()); str.remove_prefix(1))
+		value = value * 10 + (str.front() - '0');
+	return negative ? -value : value;
+}
+
 template<typename IntegralT> requires std::is_integral_v<IntegralT>
 [[nodiscard]] constexpr std::size_t count_digits(IntegralT number) {
 	std::size_t digits{1};
@@ -186,10 +238,24 @@ template<typename IntegralT> requires std::is_integral_v<IntegralT>
 	return digits;
 }
 
+/* Wide enough for products of two 64-bit values */
+using uint128 = unsigned __int128;
+
+/* std::to_string has no overload for 128-bit integers */
+[[nodiscard]] std::string to_string(uint128 value) {
+	std::string digits;
+	do {
+		digits += static_cast<char>('0' + static_cast<int>(value % 10));
+		value /= 10;
+	} while (value != 0);
+	std::ranges::reverse(digits);
+	return digits;
+}
+
 /* --- Algorithm Functors --- */
 
 struct Is_Digit {
-	[[nodiscard]] bool operator()(char c) const noexcept {
+	[[nodiscard]] constexpr bool operator()(char c) const noexcept {
 		return is_digit(c);
 	}
 };
@@ -434,7 +500,18 @@ void print_grid_positions(const PositionsT &positions, std::size_t min_x, std::s
 
 /* --- Boilerplate --- */
 
+#ifdef ADVENT_EMBEDDED_INPUT
+#include "embedded_input.h"
+#endif
+
+std::string read_input(std::istream &in) {
+	return std::string{std::istreambuf_iterator<char>{in}, std::istreambuf_iterator<char>{}};
+}
+
 uint select_part(int argc, char *argv[]) {
+	/* Lets std::cin read through its own fixed-size buffer rather than a character at a time through stdio */
+	std::ios_base::sync_with_stdio(false);
+
 	if (argc < 2) {
 		std::cerr << "Usage: " << argv[0] << " <1|2>" << std::endl;
 		std::exit(1);
@@ -449,3 +526,8 @@ uint select_part(int argc, char *argv[]) {
 		std::exit(1);
 	}
 }
+
+/* Any arguments after the part, for days with optional modes */
+std::vector<std::string_view> extra_arguments(int argc, char *argv[]) {
+	return argc > 2 ? std::vector<std::string_view>(argv + 2, argv + argc) : std::vector<std::string_view>{};
+}